@@ -2,7 +2,20 @@ import os
 
 import torch
 
-from .seq_nms import seq_nms, seq_nms_from_list  # noqa: F401
+from .seq_nms import (  # noqa: F401
+    seq_nms,
+    seq_nms_,
+    seq_nms_async,
+    seq_nms_batched,
+    seq_nms_bounded,
+    seq_nms_from_list,
+    seq_nms_packed,
+    seq_nms_stream,
+    seq_nms_sweep,
+    seq_nms_with_sequences,
+    seq_nms_with_stats,
+    seq_nms_workspace,
+)
 
 if os.name == "nt":
     file = "seq_nms.pyd"
@@ -12,3 +25,6 @@ else:
 # TODO: see why the .so files is installed below our package folder
 this_dir = os.path.dirname(__file__)
 torch.ops.load_library(os.path.join(this_dir, "..", file))  # type: ignore
+
+# the fake implementations are registered for ops of the loaded library
+from . import _fake  # noqa: E402, F401
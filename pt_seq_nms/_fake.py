@@ -0,0 +1,99 @@
+"""
+Fake implementations of the seq_nms ops, they give torch.compile the shapes and types of the results without running
+seq-nms. seq_nms, seq_nms.out and seq_nms_ have Meta kernels instead, see op.cpp. Imported once the library is loaded.
+"""
+
+from typing import List, Optional, Tuple
+
+import torch
+
+
+@torch.library.register_fake("seq_nms::seq_nms_batched")
+def _seq_nms_batched_fake(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metric: str,
+    class_aware: bool,
+    disjoint_sequences: bool,
+    score_threshold: Optional[float],
+    max_boxes_per_frame: Optional[int],
+) -> torch.Tensor:
+    return torch.empty_like(scores)
+
+
+@torch.library.register_fake("seq_nms::seq_nms_packed")
+def _seq_nms_packed_fake(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    frame_offsets: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metric: str,
+    class_aware: bool,
+    disjoint_sequences: bool,
+    score_threshold: Optional[float],
+    max_boxes_per_frame: Optional[int],
+) -> torch.Tensor:
+    return torch.empty_like(scores)
+
+
+@torch.library.register_fake("seq_nms::seq_nms_chunked")
+def _seq_nms_chunked_fake(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metric: str,
+    class_aware: bool,
+    disjoint_sequences: bool,
+    score_threshold: Optional[float],
+    max_boxes_per_frame: Optional[int],
+    *,
+    chunk_size: int,
+    chunk_overlap: int,
+) -> torch.Tensor:
+    return torch.empty_like(scores)
+
+
+@torch.library.register_fake("seq_nms::seq_nms_sweep")
+def _seq_nms_sweep_fake(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_thresholds: List[float],
+    metrics: List[str],
+    class_aware: bool,
+    disjoint_sequences: bool,
+    score_threshold: Optional[float],
+    max_boxes_per_frame: Optional[int],
+) -> torch.Tensor:
+    return scores.new_empty((len(iou_thresholds),) + tuple(scores.shape))
+
+
+@torch.library.register_fake("seq_nms::seq_nms_with_sequences")
+def _seq_nms_with_sequences_fake(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metric: str,
+    class_aware: bool,
+    disjoint_sequences: bool,
+    score_threshold: Optional[float],
+    max_boxes_per_frame: Optional[int],
+) -> Tuple[torch.Tensor, torch.Tensor, torch.Tensor, torch.Tensor]:
+    # the number of sequences depends on the values of the boxes and scores
+    num_sequences = torch.library.get_ctx().new_dynamic_size()
+    return (
+        torch.empty_like(scores),
+        scores.new_empty(scores.shape, dtype=torch.int64),
+        scores.new_empty((num_sequences,)),
+        scores.new_empty((num_sequences,), dtype=torch.int64),
+    )
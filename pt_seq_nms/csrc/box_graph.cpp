@@ -0,0 +1,230 @@
+#include "box_graph.h"
+#include <algorithm>
+
+static std::vector<int> frame_sizes_from_adjacency(const adjacency_list_t& adjacency, const int& num_last_frame_boxes) {
+    std::vector<int> frame_sizes;
+    for (const auto& frame_edges : adjacency) {
+        frame_sizes.push_back(frame_edges.size());
+    }
+    frame_sizes.push_back(num_last_frame_boxes);
+    return frame_sizes;
+}
+
+BoxGraph::BoxGraph(const std::vector<int>& frame_sizes) {
+    /*
+    Creates a graph without edges where frame f has frame_sizes[f] boxes, all of them alive.
+    */
+
+    reset(frame_sizes);
+}
+
+void BoxGraph::reset(const std::vector<int>& frame_sizes) {
+    /*
+    Replaces the graph by a graph without edges where frame f has frame_sizes[f] boxes, all of them alive.
+    The memory of the previous graph is reused, so resetting a graph to a size it already had doesn't allocate.
+    */
+
+    int num_frames = frame_sizes.size();
+
+    frame_offsets_.assign(num_frames + 1, 0);
+    alive_offsets_.assign(num_frames + 1, 0);
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        int num_words = std::max((frame_sizes[f_idx] + 63) / 64, 1);
+        frame_offsets_[f_idx + 1] = frame_offsets_[f_idx] + frame_sizes[f_idx];
+        alive_offsets_[f_idx + 1] = alive_offsets_[f_idx] + num_words;
+    }
+
+    alive_.resize(alive_offsets_.back());
+    restore_boxes();
+
+    // links past the last frame are only kept for their memory
+    if (static_cast<int>(links_.size()) < num_frames - 1) {
+        links_.resize(num_frames - 1);
+    }
+    for (int f_idx = 0; f_idx < num_frames - 1; f_idx++) {
+        clear_frame_links(f_idx);
+    }
+}
+
+void BoxGraph::append_frame(const int& num_boxes) {
+    /*
+    Adds a frame of @num_boxes alive boxes after the last frame, the previous last frame doesn't link to it until its
+    links are set, see set_frame_links. The other frames are left as they are, so a graph can slide over a stream of
+    frames together with remove_first_frame.
+    */
+
+    int num_words = std::max((num_boxes + 63) / 64, 1);
+    frame_offsets_.push_back(frame_offsets_.back() + num_boxes);
+    alive_offsets_.push_back(alive_offsets_.back() + num_words);
+    alive_.resize(alive_offsets_.back());
+    restore_frame(num_frames() - 1);
+
+    if (num_frames() > 1) {
+        if (static_cast<int>(links_.size()) < num_frames() - 1) {
+            links_.resize(num_frames() - 1);
+        }
+        clear_frame_links(num_frames() - 2);
+    }
+}
+
+void BoxGraph::remove_first_frame() {
+    /*
+    Removes the first frame and its links, the other frames keep their boxes, links and alive masks.
+    */
+
+    int num_first_boxes = frame_offsets_[1];
+    int num_first_words = alive_offsets_[1];
+
+    alive_.erase(alive_.begin(), alive_.begin() + num_first_words);
+    frame_offsets_.erase(frame_offsets_.begin());
+    alive_offsets_.erase(alive_offsets_.begin());
+    for (int f_idx = 0; f_idx < frame_offsets_.size(); f_idx++) {
+        frame_offsets_[f_idx] -= num_first_boxes;
+        alive_offsets_[f_idx] -= num_first_words;
+    }
+
+    // the links of the removed frame are moved past the last frame, where they are only kept for their memory
+    if (!links_.empty()) {
+        std::rotate(links_.begin(), links_.begin() + 1, links_.end());
+    }
+}
+
+void BoxGraph::restore_frame(const int& frame_idx) {
+    // makes every box of frame @frame_idx alive
+    for (int w_idx = alive_offsets_[frame_idx]; w_idx < alive_offsets_[frame_idx + 1]; w_idx++) {
+        int num_bits = std::min(std::max(num_boxes(frame_idx) - 64 * (w_idx - alive_offsets_[frame_idx]), 0), 64);
+        alive_[w_idx] = num_bits == 64 ? ~uint64_t(0) : (uint64_t(1) << num_bits) - 1;
+    }
+}
+
+void BoxGraph::clear_frame_links(const int& frame_idx) {
+    // removes the links from frame @frame_idx to the next frame, in the layout of their sizes, see frame_links_t
+    frame_links_t& links = links_[frame_idx];
+    if (is_bitset_frame(frame_idx)) {
+        links.rows.assign(num_boxes(frame_idx), 0);
+    } else {
+        links.offsets.assign(num_boxes(frame_idx) + 1, 0);
+        links.edges.clear();
+    }
+}
+
+BoxGraph::BoxGraph(const adjacency_list_t& adjacency, const int& num_last_frame_boxes)
+    : BoxGraph(frame_sizes_from_adjacency(adjacency, num_last_frame_boxes)) {
+    /*
+    Creates a graph from @adjacency, where adjacency[f][b] are the boxes in frame f + 1 that box b in frame f links to.
+    */
+
+    std::vector<int> offsets;
+    std::vector<int> edges;
+    for (int f_idx = 0; f_idx < adjacency.size(); f_idx++) {
+        offsets.assign(1, 0);
+        edges.clear();
+
+        for (const auto& box_edges : adjacency[f_idx]) {
+            edges.insert(edges.end(), box_edges.begin(), box_edges.end());
+            offsets.push_back(edges.size());
+        }
+
+        set_frame_links(f_idx, offsets, edges);
+    }
+}
+
+void BoxGraph::set_frame_links(const int& frame_idx, const std::vector<int>& offsets, const std::vector<int>& edges) {
+    /*
+    Sets the edges from frame @frame_idx to frame @frame_idx + 1 given in CSR layout, see frame_links_t.
+    Only the links of @frame_idx are written, so different frames can be set concurrently.
+    */
+
+    frame_links_t& links = links_[frame_idx];
+
+    if (is_bitset_frame(frame_idx)) {
+        std::fill(links.rows.begin(), links.rows.end(), 0);
+        for (int box_idx = 0; box_idx < num_boxes(frame_idx); box_idx++) {
+            for (int i = offsets[box_idx]; i < offsets[box_idx + 1]; i++) {
+                links.rows[box_idx] |= uint64_t(1) << edges[i];
+            }
+        }
+    } else {
+        links.offsets = offsets;
+        links.edges = edges;
+    }
+}
+
+void BoxGraph::restore_boxes() {
+    /*
+    Makes every box alive again, undoing remove_box. The edges are kept, so a graph can be extracted from again without
+    linking its frames again.
+    */
+
+    for (int f_idx = 0; f_idx < num_frames(); f_idx++) {
+        restore_frame(f_idx);
+    }
+}
+
+int BoxGraph::num_edges(const int& frame_idx, const int& box_idx) const {
+    /*
+    Returns the number of edges from box @box_idx in frame @frame_idx to alive boxes in the next frame.
+    */
+
+    if (frame_idx >= num_frames() - 1) {
+        return 0;
+    }
+
+    if (is_bitset_frame(frame_idx)) {
+        if (!is_alive(frame_idx, box_idx)) {
+            return 0;
+        }
+        return count_ones(links_[frame_idx].rows[box_idx] & alive_[alive_offsets_[frame_idx + 1]]);
+    }
+
+    int count = 0;
+    for_each_edge(frame_idx, box_idx, [&count](const int& e_idx) { count++; });
+    return count;
+}
+
+int64_t BoxGraph::num_edges() const {
+    /*
+    Returns the number of edges between alive boxes in the graph.
+    */
+
+    int64_t count = 0;
+    for (int f_idx = 0; f_idx < num_frames() - 1; f_idx++) {
+        for (int box_idx = 0; box_idx < num_boxes(f_idx); box_idx++) {
+            count += num_edges(f_idx, box_idx);
+        }
+    }
+    return count;
+}
+
+int64_t BoxGraph::num_bytes() const {
+    /*
+    Returns the number of bytes allocated by the graph.
+    */
+
+    int64_t bytes = sizeof(BoxGraph);
+    bytes += frame_offsets_.capacity() * sizeof(int) + alive_offsets_.capacity() * sizeof(int);
+    bytes += alive_.capacity() * sizeof(uint64_t) + links_.capacity() * sizeof(frame_links_t);
+    for (const frame_links_t& links : links_) {
+        bytes += links.offsets.capacity() * sizeof(int) + links.edges.capacity() * sizeof(int);
+        bytes += links.rows.capacity() * sizeof(uint64_t);
+    }
+    return bytes;
+}
+
+adjacency_list_t BoxGraph::to_adjacency() const {
+    /*
+    Converts the graph to nested vectors of the edges between alive boxes, see BoxGraph(adjacency, num_last_frame_boxes).
+    */
+
+    adjacency_list_t adjacency(std::max(num_frames() - 1, 0));
+    for (int f_idx = 0; f_idx < adjacency.size(); f_idx++) {
+        adjacency[f_idx].resize(num_boxes(f_idx));
+
+        for (int box_idx = 0; box_idx < num_boxes(f_idx); box_idx++) {
+            std::vector<int>& box_edges = adjacency[f_idx][box_idx];
+            for_each_edge(f_idx, box_idx, [&box_edges](const int& e_idx) { box_edges.push_back(e_idx); });
+        }
+    }
+
+    return adjacency;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "custom_types.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// frames followed by a frame with at most this many boxes store their edges as one bitset row per box
+const int BITSET_MAX_BOXES = 64;
+
+inline int count_trailing_zeros(const uint64_t& x) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return static_cast<int>(idx);
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+inline int count_ones(const uint64_t& x) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(x));
+#else
+    return __builtin_popcountll(x);
+#endif
+}
+
+struct frame_links_t {
+    /*
+    The edges from the boxes in frame f to the boxes in frame f + 1.
+
+    If frame f + 1 has more than BITSET_MAX_BOXES boxes, they are stored in CSR layout: the edges of box b are
+    edges[offsets[b]:offsets[b + 1]], in increasing order. Otherwise rows[b] has bit e set if box b links to box e.
+    */
+
+    std::vector<int> offsets;
+    std::vector<int> edges;
+    std::vector<uint64_t> rows;
+};
+
+class BoxGraph {
+    /*
+    A graph where vertices are boxes at a given frame and edges link boxes in consecutive frames.
+
+    Boxes are removed from the graph through an alive mask, an edge only exists if both of its boxes are alive.
+    A removed box is still part of its frame, it just has no edges.
+    */
+
+  public:
+    BoxGraph() : frame_offsets_{0}, alive_offsets_{0} {}
+
+    explicit BoxGraph(const std::vector<int>& frame_sizes);
+
+    BoxGraph(const adjacency_list_t& adjacency, const int& num_last_frame_boxes);
+
+    void reset(const std::vector<int>& frame_sizes);
+
+    void set_frame_links(const int& frame_idx, const std::vector<int>& offsets, const std::vector<int>& edges);
+
+    void restore_boxes();
+
+    void append_frame(const int& num_boxes);
+
+    void remove_first_frame();
+
+    int num_frames() const {
+        return static_cast<int>(frame_offsets_.size()) - 1;
+    }
+
+    int num_boxes(const int& frame_idx) const {
+        return frame_offsets_[frame_idx + 1] - frame_offsets_[frame_idx];
+    }
+
+    int num_nodes() const {
+        return frame_offsets_.back();
+    }
+
+    int frame_offset(const int& frame_idx) const {
+        return frame_offsets_[frame_idx];
+    }
+
+    bool is_alive(const int& frame_idx, const int& box_idx) const {
+        return (alive_[alive_offsets_[frame_idx] + (box_idx >> 6)] >> (box_idx & 63)) & 1;
+    }
+
+    void remove_box(const int& frame_idx, const int& box_idx) {
+        alive_[alive_offsets_[frame_idx] + (box_idx >> 6)] &= ~(uint64_t(1) << (box_idx & 63));
+    }
+
+    template <typename F>
+    void for_each_edge(const int& frame_idx, const int& box_idx, F fn) const {
+        /*
+        Calls @fn with the index of every box in frame @frame_idx + 1 that box @box_idx links to, in increasing order.
+        */
+
+        if (!is_alive(frame_idx, box_idx)) {
+            return;
+        }
+
+        const frame_links_t& links = links_[frame_idx];
+        if (is_bitset_frame(frame_idx)) {
+            uint64_t row = links.rows[box_idx] & alive_[alive_offsets_[frame_idx + 1]];
+            while (row != 0) {
+                fn(count_trailing_zeros(row));
+                row &= row - 1;
+            }
+        } else {
+            for (int i = links.offsets[box_idx]; i < links.offsets[box_idx + 1]; i++) {
+                int e_idx = links.edges[i];
+                if (is_alive(frame_idx + 1, e_idx)) {
+                    fn(e_idx);
+                }
+            }
+        }
+    }
+
+    bool is_bitset_frame(const int& frame_idx) const {
+        return num_boxes(frame_idx + 1) <= BITSET_MAX_BOXES;
+    }
+
+    int num_edges(const int& frame_idx, const int& box_idx) const;
+
+    int64_t num_edges() const;
+
+    int64_t num_bytes() const;
+
+    adjacency_list_t to_adjacency() const;
+
+  private:
+    void restore_frame(const int& frame_idx);
+
+    void clear_frame_links(const int& frame_idx);
+
+    // index of the first box of each frame, has the length F + 1
+    std::vector<int> frame_offsets_;
+    // links between frame f and f + 1, has at least the length F - 1, see reset
+    std::vector<frame_links_t> links_;
+    // one bit per box, each frame starts on a new word and has at least one word
+    std::vector<uint64_t> alive_;
+    // index of the first alive word of each frame, has the length F + 1
+    std::vector<int> alive_offsets_;
+};
@@ -1,4 +1,8 @@
 #include "box_utils.h"
+#include <ATen/Dispatch.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "custom_types.h"
 
 using namespace torch::indexing;
@@ -45,3 +49,593 @@ torch::Tensor calculate_iou_given_area(
     auto iou = torch::div(intersection, union_ + EPS);
     return iou;
 }
+
+boxes_soa_t to_boxes_soa(const torch::Tensor& boxes) {
+    /*
+    Converts @boxes to the structure-of-arrays layout and computes their areas.
+
+    boxes are expected to have the shape [F, N, 4] and of the format [x_min, y_min, x_max, y_max].
+        They can have any floating point type, the coordinates are converted to float while they are read.
+    */
+
+    boxes_soa_t soa;
+    to_boxes_soa(boxes, soa);
+    return soa;
+}
+
+void to_boxes_soa(const torch::Tensor& boxes, boxes_soa_t& soa) {
+    /*
+    Same as to_boxes_soa(boxes), but overwrites @soa and reuses its memory.
+    */
+
+    int num_frames = boxes.size(0);
+    int num_boxes = boxes.size(1);
+
+    soa.x1.resize(num_frames * num_boxes);
+    soa.y1.resize(num_frames * num_boxes);
+    soa.x2.resize(num_frames * num_boxes);
+    soa.y2.resize(num_frames * num_boxes);
+    soa.areas.resize(num_frames * num_boxes);
+    soa.frame_offsets.resize(num_frames + 1);
+
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::kHalf, at::kBFloat16, boxes.scalar_type(), "to_boxes_soa", [&] {
+        auto boxes_acc = boxes.accessor<scalar_t, 3>();
+
+        for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+            soa.frame_offsets[f_idx] = f_idx * num_boxes;
+
+            for (int b_idx = 0; b_idx < num_boxes; b_idx++) {
+                int idx = f_idx * num_boxes + b_idx;
+                soa.x1[idx] = static_cast<float>(boxes_acc[f_idx][b_idx][0]);
+                soa.y1[idx] = static_cast<float>(boxes_acc[f_idx][b_idx][1]);
+                soa.x2[idx] = static_cast<float>(boxes_acc[f_idx][b_idx][2]);
+                soa.y2[idx] = static_cast<float>(boxes_acc[f_idx][b_idx][3]);
+                soa.areas[idx] = (soa.x2[idx] - soa.x1[idx]) * (soa.y2[idx] - soa.y1[idx]);
+            }
+        }
+    });
+    soa.frame_offsets[num_frames] = num_frames * num_boxes;
+
+    build_spatial_index(soa, SPATIAL_INDEX_MIN_BOXES);
+}
+
+boxes_soa_t to_boxes_soa(const torch::Tensor& boxes, const std::vector<int>& frame_offsets) {
+    /*
+    Converts packed @boxes to the structure-of-arrays layout and computes their areas.
+
+    boxes are expected to have the shape [S, 4] and of the format [x_min, y_min, x_max, y_max], where the boxes of
+        frame f are boxes[frame_offsets[f]:frame_offsets[f + 1]] and S is frame_offsets[F]. They can have any floating
+        point type, see to_boxes_soa(boxes).
+    */
+
+    boxes_soa_t soa;
+    to_boxes_soa(boxes, frame_offsets, soa);
+    return soa;
+}
+
+void to_boxes_soa(const torch::Tensor& boxes, const std::vector<int>& frame_offsets, boxes_soa_t& soa) {
+    /*
+    Same as to_boxes_soa(boxes, frame_offsets), but overwrites @soa and reuses its memory.
+    */
+
+    int num_boxes = boxes.size(0);
+
+    soa.x1.resize(num_boxes);
+    soa.y1.resize(num_boxes);
+    soa.x2.resize(num_boxes);
+    soa.y2.resize(num_boxes);
+    soa.areas.resize(num_boxes);
+    soa.frame_offsets = frame_offsets;
+
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::kHalf, at::kBFloat16, boxes.scalar_type(), "to_boxes_soa", [&] {
+        auto boxes_acc = boxes.accessor<scalar_t, 2>();
+
+        for (int idx = 0; idx < num_boxes; idx++) {
+            soa.x1[idx] = static_cast<float>(boxes_acc[idx][0]);
+            soa.y1[idx] = static_cast<float>(boxes_acc[idx][1]);
+            soa.x2[idx] = static_cast<float>(boxes_acc[idx][2]);
+            soa.y2[idx] = static_cast<float>(boxes_acc[idx][3]);
+            soa.areas[idx] = (soa.x2[idx] - soa.x1[idx]) * (soa.y2[idx] - soa.y1[idx]);
+        }
+    });
+
+    build_spatial_index(soa, SPATIAL_INDEX_MIN_BOXES);
+}
+
+static void index_frame(boxes_soa_t& boxes, const int& f_idx, const int& index_min_boxes) {
+    /*
+    Builds the sweep and prune index of frame @f_idx of @boxes if it has at least @index_min_boxes boxes, the frames
+    before it must already be indexed and the frames after it not.
+    */
+
+    int frame_offset = boxes.frame_offsets[f_idx];
+    int num_boxes = boxes.frame_offsets[f_idx + 1] - frame_offset;
+    int sorted_begin = boxes.sorted_boxes.size();
+
+    boxes.indexed_frames.push_back(num_boxes >= index_min_boxes);
+    if (num_boxes >= index_min_boxes) {
+        for (int b_idx = 0; b_idx < num_boxes; b_idx++) {
+            if (!std::isnan(boxes.areas[frame_offset + b_idx])) {
+                boxes.sorted_boxes.push_back(b_idx);
+            }
+        }
+        std::stable_sort(
+            boxes.sorted_boxes.begin() + sorted_begin, boxes.sorted_boxes.end(), [&](const int& a, const int& b) {
+                return boxes.x1[frame_offset + a] < boxes.x1[frame_offset + b];
+            });
+
+        float max_x2 = -std::numeric_limits<float>::infinity();
+        for (int i = sorted_begin; i < boxes.sorted_boxes.size(); i++) {
+            int idx = frame_offset + boxes.sorted_boxes[i];
+            max_x2 = std::max(max_x2, boxes.x2[idx]);
+            boxes.sorted_x1.push_back(boxes.x1[idx]);
+            boxes.sorted_y1.push_back(boxes.y1[idx]);
+            boxes.sorted_x2.push_back(boxes.x2[idx]);
+            boxes.sorted_y2.push_back(boxes.y2[idx]);
+            boxes.sorted_areas.push_back(boxes.areas[idx]);
+            boxes.sorted_max_x2.push_back(max_x2);
+        }
+    }
+
+    boxes.sorted_offsets.push_back(boxes.sorted_boxes.size());
+}
+
+void build_spatial_index(boxes_soa_t& boxes, const int& index_min_boxes) {
+    /*
+    Builds the sweep and prune index of every frame with at least @index_min_boxes boxes, see boxes_soa_t.
+    */
+
+    int num_frames = boxes.frame_offsets.size() - 1;
+
+    boxes.indexed_frames.clear();
+    boxes.sorted_offsets.assign(1, 0);
+    boxes.sorted_boxes.clear();
+    boxes.sorted_x1.clear();
+    boxes.sorted_y1.clear();
+    boxes.sorted_x2.clear();
+    boxes.sorted_y2.clear();
+    boxes.sorted_areas.clear();
+    boxes.sorted_max_x2.clear();
+
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        index_frame(boxes, f_idx, index_min_boxes);
+    }
+}
+
+boxes_soa_t select_boxes(const boxes_soa_t& boxes, const std::vector<int>& frame_offsets, const std::vector<int>& box_indices) {
+    /*
+    Copies a subset of @boxes into a new indexed clip with the same number of frames.
+
+    box_indices are indices into @boxes, the boxes of frame f of the new clip are
+        box_indices[frame_offsets[f]:frame_offsets[f + 1]] and are expected to be boxes of frame f.
+    */
+
+    boxes_soa_t soa;
+    select_boxes(boxes, frame_offsets, box_indices, soa);
+    return soa;
+}
+
+void select_boxes(
+    const boxes_soa_t& boxes,
+    const std::vector<int>& frame_offsets,
+    const std::vector<int>& box_indices,
+    boxes_soa_t& soa) {
+    /*
+    Same as select_boxes(boxes, frame_offsets, box_indices), but overwrites @soa and reuses its memory.
+    */
+
+    soa.frame_offsets = frame_offsets;
+    soa.x1.clear();
+    soa.y1.clear();
+    soa.x2.clear();
+    soa.y2.clear();
+    soa.areas.clear();
+    soa.x1.reserve(box_indices.size());
+    soa.y1.reserve(box_indices.size());
+    soa.x2.reserve(box_indices.size());
+    soa.y2.reserve(box_indices.size());
+    soa.areas.reserve(box_indices.size());
+
+    for (int idx : box_indices) {
+        soa.x1.push_back(boxes.x1[idx]);
+        soa.y1.push_back(boxes.y1[idx]);
+        soa.x2.push_back(boxes.x2[idx]);
+        soa.y2.push_back(boxes.y2[idx]);
+        soa.areas.push_back(boxes.areas[idx]);
+    }
+
+    build_spatial_index(soa, SPATIAL_INDEX_MIN_BOXES);
+}
+
+void append_frame(boxes_soa_t& boxes, const torch::Tensor& frame_boxes) {
+    /*
+    Appends a frame to @boxes and indexes it, see to_boxes_soa.
+
+    frame_boxes are expected to have the shape [N, 4] and of the format [x_min, y_min, x_max, y_max].
+        They can have any floating point type, see to_boxes_soa.
+    */
+
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::kHalf, at::kBFloat16, frame_boxes.scalar_type(), "append_frame", [&] {
+        auto boxes_acc = frame_boxes.accessor<scalar_t, 2>();
+
+        for (int b_idx = 0; b_idx < boxes_acc.size(0); b_idx++) {
+            float x1 = static_cast<float>(boxes_acc[b_idx][0]);
+            float y1 = static_cast<float>(boxes_acc[b_idx][1]);
+            float x2 = static_cast<float>(boxes_acc[b_idx][2]);
+            float y2 = static_cast<float>(boxes_acc[b_idx][3]);
+
+            boxes.x1.push_back(x1);
+            boxes.y1.push_back(y1);
+            boxes.x2.push_back(x2);
+            boxes.y2.push_back(y2);
+            boxes.areas.push_back((x2 - x1) * (y2 - y1));
+        }
+    });
+    boxes.frame_offsets.push_back(boxes.x1.size());
+
+    index_frame(boxes, boxes.frame_offsets.size() - 2, SPATIAL_INDEX_MIN_BOXES);
+}
+
+void remove_first_frame(boxes_soa_t& boxes) {
+    /*
+    Removes the first frame of @boxes, box b of frame f + 1 becomes box b of frame f.
+    */
+
+    int num_boxes = boxes.frame_offsets[1];
+    int num_sorted = boxes.sorted_offsets[1];
+
+    for (auto* values : {&boxes.x1, &boxes.y1, &boxes.x2, &boxes.y2, &boxes.areas}) {
+        values->erase(values->begin(), values->begin() + num_boxes);
+    }
+    for (auto* values :
+         {&boxes.sorted_x1, &boxes.sorted_y1, &boxes.sorted_x2, &boxes.sorted_y2, &boxes.sorted_areas, &boxes.sorted_max_x2}) {
+        values->erase(values->begin(), values->begin() + num_sorted);
+    }
+    boxes.sorted_boxes.erase(boxes.sorted_boxes.begin(), boxes.sorted_boxes.begin() + num_sorted);
+    boxes.indexed_frames.erase(boxes.indexed_frames.begin());
+
+    boxes.frame_offsets.erase(boxes.frame_offsets.begin());
+    boxes.sorted_offsets.erase(boxes.sorted_offsets.begin());
+    for (int& offset : boxes.frame_offsets) {
+        offset -= num_boxes;
+    }
+    for (int& offset : boxes.sorted_offsets) {
+        offset -= num_sorted;
+    }
+}
+
+// The kernels below must give the same IOU as calculate_iou_given_area, bit for bit,
+// so contracting the multiplication and subtraction into a FMA is not allowed.
+#if defined(__GNUC__) && !defined(__clang__)
+#define NO_FP_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define NO_FP_CONTRACT
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAS_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+struct box_t {
+    float x1;
+    float y1;
+    float x2;
+    float y2;
+    float area;
+};
+
+struct box_columns_t {
+    const float* x1;
+    const float* y1;
+    const float* x2;
+    const float* y2;
+    const float* areas;
+};
+
+typedef void (*overlap_kernel_t)(const box_t&, const box_columns_t&, const int&, const int&, const float&, std::vector<int>&);
+
+NO_FP_CONTRACT static void append_overlapping_boxes(
+    const box_t& box,
+    const box_columns_t& others,
+    const int& begin,
+    const int& end,
+    const int& index_base,
+    const float& iou_threshold,
+    std::vector<int>& overlapping) {
+    for (int idx = begin; idx < end; idx++) {
+        float inter_w = std::max(std::min(box.x2, others.x2[idx]) - std::max(box.x1, others.x1[idx]), 0.0f);
+        float inter_h = std::max(std::min(box.y2, others.y2[idx]) - std::max(box.y1, others.y1[idx]), 0.0f);
+        float intersection = inter_w * inter_h;
+        float union_ = box.area + others.areas[idx] - intersection;
+
+        if (intersection / (union_ + EPS) >= iou_threshold) {
+            overlapping.push_back(idx - index_base);
+        }
+    }
+}
+
+static void find_overlapping_boxes_scalar(
+    const box_t& box,
+    const box_columns_t& others,
+    const int& others_begin,
+    const int& others_end,
+    const float& iou_threshold,
+    std::vector<int>& overlapping) {
+    append_overlapping_boxes(box, others, others_begin, others_end, others_begin, iou_threshold, overlapping);
+}
+
+#ifdef HAS_X86_KERNELS
+__attribute__((target("avx2"))) NO_FP_CONTRACT static void find_overlapping_boxes_avx2(
+    const box_t& box,
+    const box_columns_t& others,
+    const int& others_begin,
+    const int& others_end,
+    const float& iou_threshold,
+    std::vector<int>& overlapping) {
+    __m256 x1 = _mm256_set1_ps(box.x1);
+    __m256 y1 = _mm256_set1_ps(box.y1);
+    __m256 x2 = _mm256_set1_ps(box.x2);
+    __m256 y2 = _mm256_set1_ps(box.y2);
+    __m256 area = _mm256_set1_ps(box.area);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 eps = _mm256_set1_ps(EPS);
+    __m256 threshold = _mm256_set1_ps(iou_threshold);
+
+    int idx = others_begin;
+    for (; idx + 8 <= others_end; idx += 8) {
+        __m256 inter_w = _mm256_sub_ps(
+            _mm256_min_ps(x2, _mm256_loadu_ps(&others.x2[idx])), _mm256_max_ps(x1, _mm256_loadu_ps(&others.x1[idx])));
+        __m256 inter_h = _mm256_sub_ps(
+            _mm256_min_ps(y2, _mm256_loadu_ps(&others.y2[idx])), _mm256_max_ps(y1, _mm256_loadu_ps(&others.y1[idx])));
+        __m256 intersection = _mm256_mul_ps(_mm256_max_ps(inter_w, zero), _mm256_max_ps(inter_h, zero));
+        __m256 union_ = _mm256_sub_ps(_mm256_add_ps(area, _mm256_loadu_ps(&others.areas[idx])), intersection);
+        __m256 iou = _mm256_div_ps(intersection, _mm256_add_ps(union_, eps));
+
+        unsigned int mask = _mm256_movemask_ps(_mm256_cmp_ps(iou, threshold, _CMP_GE_OQ));
+        while (mask != 0) {
+            overlapping.push_back(idx - others_begin + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    append_overlapping_boxes(box, others, idx, others_end, others_begin, iou_threshold, overlapping);
+}
+
+__attribute__((target("avx512f"))) NO_FP_CONTRACT static void find_overlapping_boxes_avx512(
+    const box_t& box,
+    const box_columns_t& others,
+    const int& others_begin,
+    const int& others_end,
+    const float& iou_threshold,
+    std::vector<int>& overlapping) {
+    __m512 x1 = _mm512_set1_ps(box.x1);
+    __m512 y1 = _mm512_set1_ps(box.y1);
+    __m512 x2 = _mm512_set1_ps(box.x2);
+    __m512 y2 = _mm512_set1_ps(box.y2);
+    __m512 area = _mm512_set1_ps(box.area);
+    __m512 zero = _mm512_setzero_ps();
+    __m512 eps = _mm512_set1_ps(EPS);
+    __m512 threshold = _mm512_set1_ps(iou_threshold);
+
+    int idx = others_begin;
+    for (; idx + 16 <= others_end; idx += 16) {
+        __m512 inter_w = _mm512_sub_ps(
+            _mm512_min_ps(x2, _mm512_loadu_ps(&others.x2[idx])), _mm512_max_ps(x1, _mm512_loadu_ps(&others.x1[idx])));
+        __m512 inter_h = _mm512_sub_ps(
+            _mm512_min_ps(y2, _mm512_loadu_ps(&others.y2[idx])), _mm512_max_ps(y1, _mm512_loadu_ps(&others.y1[idx])));
+        __m512 intersection = _mm512_mul_ps(_mm512_max_ps(inter_w, zero), _mm512_max_ps(inter_h, zero));
+        __m512 union_ = _mm512_sub_ps(_mm512_add_ps(area, _mm512_loadu_ps(&others.areas[idx])), intersection);
+        __m512 iou = _mm512_div_ps(intersection, _mm512_add_ps(union_, eps));
+
+        unsigned int mask = _mm512_cmp_ps_mask(iou, threshold, _CMP_GE_OQ);
+        while (mask != 0) {
+            overlapping.push_back(idx - others_begin + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    append_overlapping_boxes(box, others, idx, others_end, others_begin, iou_threshold, overlapping);
+}
+#endif
+
+static overlap_kernel_t select_overlap_kernel() {
+    /*
+    Picks the widest kernel the CPU supports.
+    */
+
+#ifdef HAS_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return find_overlapping_boxes_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return find_overlapping_boxes_avx2;
+    }
+#endif
+    return find_overlapping_boxes_scalar;
+}
+
+static const overlap_kernel_t overlap_kernel = select_overlap_kernel();
+
+static box_t get_box(const boxes_soa_t& boxes, const int& box_idx) {
+    return {boxes.x1[box_idx], boxes.y1[box_idx], boxes.x2[box_idx], boxes.y2[box_idx], boxes.areas[box_idx]};
+}
+
+void find_overlapping_boxes_dense(
+    const boxes_soa_t& boxes,
+    const int& box_idx,
+    const int& frame_idx,
+    const float& iou_threshold,
+    std::vector<int>& overlapping) {
+    /*
+    Appends to @overlapping the boxes in frame @frame_idx which have an IOU of at least @iou_threshold with box @box_idx,
+    by comparing against every box of the frame. Box indices are within the frame and appended in increasing order.
+
+    The IOU is the same as calculate_iou_given_area.
+    */
+
+    box_columns_t others{boxes.x1.data(), boxes.y1.data(), boxes.x2.data(), boxes.y2.data(), boxes.areas.data()};
+    overlap_kernel(
+        get_box(boxes, box_idx),
+        others,
+        boxes.frame_offsets[frame_idx],
+        boxes.frame_offsets[frame_idx + 1],
+        iou_threshold,
+        overlapping);
+}
+
+void find_overlapping_boxes_indexed(
+    const boxes_soa_t& boxes,
+    const int& box_idx,
+    const int& frame_idx,
+    const float& iou_threshold,
+    std::vector<int>& overlapping) {
+    /*
+    Same as find_overlapping_boxes_dense, but only compares against the boxes whose x extent can intersect box @box_idx.
+    Frame @frame_idx must be indexed and @iou_threshold must be positive, as an IOU > 0 needs the extents to intersect.
+    */
+
+    box_t box = get_box(boxes, box_idx);
+    int sorted_begin = boxes.sorted_offsets[frame_idx];
+    int sorted_end = boxes.sorted_offsets[frame_idx + 1];
+
+    // boxes from candidates_end on start right of the box, the running maximum of x2 is sorted as well so boxes before
+    // candidates_begin all end left of the box
+    const float* sorted_x1 = boxes.sorted_x1.data();
+    const float* sorted_max_x2 = boxes.sorted_max_x2.data();
+    int candidates_end = std::lower_bound(sorted_x1 + sorted_begin, sorted_x1 + sorted_end, box.x2) - sorted_x1;
+    int candidates_begin =
+        std::upper_bound(sorted_max_x2 + sorted_begin, sorted_max_x2 + candidates_end, box.x1) - sorted_max_x2;
+
+    if (candidates_begin >= candidates_end) {
+        return;
+    }
+
+    int num_overlapping = overlapping.size();
+    box_columns_t sorted{
+        boxes.sorted_x1.data(),
+        boxes.sorted_y1.data(),
+        boxes.sorted_x2.data(),
+        boxes.sorted_y2.data(),
+        boxes.sorted_areas.data()};
+    overlap_kernel(box, sorted, candidates_begin, candidates_end, iou_threshold, overlapping);
+
+    for (int i = num_overlapping; i < overlapping.size(); i++) {
+        overlapping[i] = boxes.sorted_boxes[candidates_begin + overlapping[i]];
+    }
+    std::sort(overlapping.begin() + num_overlapping, overlapping.end());
+}
+
+void find_overlapping_boxes(
+    const boxes_soa_t& boxes,
+    const int& box_idx,
+    const int& frame_idx,
+    const float& iou_threshold,
+    std::vector<int>& overlapping) {
+    /*
+    Appends to @overlapping the boxes in frame @frame_idx which have an IOU of at least @iou_threshold with box @box_idx.
+    Box indices are within the frame and appended in increasing order.
+
+    Uses the spatial index if the frame has one, otherwise compares against every box of the frame.
+    */
+
+    if (boxes.indexed_frames[frame_idx] && (iou_threshold > 0)) {
+        find_overlapping_boxes_indexed(boxes, box_idx, frame_idx, iou_threshold, overlapping);
+    } else {
+        find_overlapping_boxes_dense(boxes, box_idx, frame_idx, iou_threshold, overlapping);
+    }
+}
+
+void clear_overlap_index(overlap_index_t& index) {
+    /*
+    Marks @index as built from no boxes, so the next prepare_overlap_index starts it over. The memory of its frames is
+    kept.
+    */
+
+    index.built.clear();
+}
+
+void prepare_overlap_index(const boxes_soa_t& boxes, const float& iou_threshold, overlap_index_t& index) {
+    /*
+    Makes @index an index of @boxes at @iou_threshold, without building any frame yet. If it already is one, the frames
+    built so far are kept, e.g. between extractions from the same boxes at the same threshold.
+    */
+
+    int num_frames = boxes.frame_offsets.size() - 1;
+    if ((index.built.size() == num_frames) && (index.iou_threshold == iou_threshold)) {
+        return;
+    }
+
+    if (index.frames.size() < num_frames) {
+        index.frames.resize(num_frames);
+    }
+    index.built.assign(num_frames, 0);
+    index.iou_threshold = iou_threshold;
+}
+
+void append_frame(overlap_index_t& index) {
+    /*
+    Adds a frame which isn't built yet after the last frame of @index, for boxes which got a frame appended, see
+    append_frame(boxes, frame_boxes).
+    */
+
+    index.built.push_back(0);
+    if (index.frames.size() < index.built.size()) {
+        index.frames.resize(index.built.size());
+    }
+}
+
+void remove_first_frame(overlap_index_t& index) {
+    /*
+    Removes the first frame of @index, for boxes which got their first frame removed, see remove_first_frame(boxes). The
+    overlaps are indexed within their frame, so the frames built so far stay valid.
+    */
+
+    // the memory of the removed frame is moved past the last frame
+    std::rotate(index.frames.begin(), index.frames.begin() + 1, index.frames.end());
+    index.built.erase(index.built.begin());
+}
+
+const frame_overlaps_t& get_frame_overlaps(const boxes_soa_t& boxes, const int& frame_idx, overlap_index_t& index) {
+    /*
+    Returns the overlaps of frame @frame_idx of @boxes in @index, which is expected to be prepared for @boxes, see
+    prepare_overlap_index. The boxes overlapping each box of the frame are found the first time the frame is looked up,
+    so frames no sequence passes through are never built.
+    */
+
+    frame_overlaps_t& frame_overlaps = index.frames[frame_idx];
+    if (index.built[frame_idx]) {
+        return frame_overlaps;
+    }
+
+    int frame_offset = boxes.frame_offsets[frame_idx];
+    int num_boxes = boxes.frame_offsets[frame_idx + 1] - frame_offset;
+
+    frame_overlaps.offsets.resize(num_boxes + 1);
+    frame_overlaps.boxes.clear();
+    for (int b_idx = 0; b_idx < num_boxes; b_idx++) {
+        frame_overlaps.offsets[b_idx] = frame_overlaps.boxes.size();
+        find_overlapping_boxes(boxes, frame_offset + b_idx, frame_idx, index.iou_threshold, frame_overlaps.boxes);
+    }
+    frame_overlaps.offsets[num_boxes] = frame_overlaps.boxes.size();
+
+    index.built[frame_idx] = 1;
+    return frame_overlaps;
+}
+
+int64_t overlap_index_bytes(const overlap_index_t& index) {
+    /*
+    Returns the number of bytes allocated by the frames built in @index. The memory kept by the other frames, e.g. from
+    an earlier clip, isn't counted.
+    */
+
+    int64_t bytes = 0;
+    for (int f_idx = 0; f_idx < index.built.size(); f_idx++) {
+        if (index.built[f_idx]) {
+            const frame_overlaps_t& frame_overlaps = index.frames[f_idx];
+            bytes += frame_overlaps.offsets.capacity() * sizeof(int) + frame_overlaps.boxes.capacity() * sizeof(int);
+        }
+    }
+    return bytes;
+}
@@ -1,5 +1,64 @@
 #pragma once
 #include <torch/torch.h>
+#include <cstdint>
+#include <vector>
+
+// frames with at least this many boxes get a spatial index, smaller frames are compared against every box
+const int SPATIAL_INDEX_MIN_BOXES = 256;
+
+struct boxes_soa_t {
+    /*
+    Boxes of a clip in structure-of-arrays layout, box b of frame f is at index frame_offsets[f] + b.
+
+    Indexed frames also keep a sweep and prune index: the boxes of the frame sorted by x1, in the same layout and
+    stored in sorted_*[sorted_offsets[f]:sorted_offsets[f + 1]]. Boxes with a NaN area can not overlap anything and are
+    left out.
+    */
+
+    std::vector<float> x1;
+    std::vector<float> y1;
+    std::vector<float> x2;
+    std::vector<float> y2;
+    std::vector<float> areas;
+    // index of the first box of each frame, has the length F + 1
+    std::vector<int> frame_offsets;
+
+    // has the length F, 1 if the frame has a spatial index
+    std::vector<uint8_t> indexed_frames;
+    // index of the first sorted box of each frame, has the length F + 1
+    std::vector<int> sorted_offsets;
+    // box index within its frame
+    std::vector<int> sorted_boxes;
+    std::vector<float> sorted_x1;
+    std::vector<float> sorted_y1;
+    std::vector<float> sorted_x2;
+    std::vector<float> sorted_y2;
+    std::vector<float> sorted_areas;
+    // running maximum of x2 over the sorted boxes of the frame
+    std::vector<float> sorted_max_x2;
+};
+
+struct frame_overlaps_t {
+    /*
+    The boxes of one frame overlapping each box of the frame in CSR layout, box b overlaps the boxes
+    boxes[offsets[b]:offsets[b + 1]] of the same frame, see get_frame_overlaps.
+    */
+
+    std::vector<int> offsets;
+    std::vector<int> boxes;
+};
+
+struct overlap_index_t {
+    /*
+    The overlaps of the frames of a clip at iou_threshold, a frame is only built the first time it is looked up, see
+    get_frame_overlaps. frames[f] are the overlaps of frame f once built[f] is set. The index doesn't know the boxes it
+    was built from, so it has to be cleared when they change, see clear_overlap_index.
+    */
+
+    std::vector<frame_overlaps_t> frames;
+    std::vector<uint8_t> built;
+    float iou_threshold = 0;
+};
 
 torch::Tensor calculate_area(const torch::Tensor& boxes);
 
@@ -8,3 +67,58 @@ torch::Tensor calculate_iou_given_area(
     const torch::Tensor& boxes_b,
     const torch::Tensor& aread_a,
     const torch::Tensor& areas_b);
+
+boxes_soa_t to_boxes_soa(const torch::Tensor& boxes);
+
+void to_boxes_soa(const torch::Tensor& boxes, boxes_soa_t& soa);
+
+boxes_soa_t to_boxes_soa(const torch::Tensor& boxes, const std::vector<int>& frame_offsets);
+
+void to_boxes_soa(const torch::Tensor& boxes, const std::vector<int>& frame_offsets, boxes_soa_t& soa);
+
+void build_spatial_index(boxes_soa_t& boxes, const int& index_min_boxes);
+
+boxes_soa_t select_boxes(const boxes_soa_t& boxes, const std::vector<int>& frame_offsets, const std::vector<int>& box_indices);
+
+void select_boxes(
+    const boxes_soa_t& boxes,
+    const std::vector<int>& frame_offsets,
+    const std::vector<int>& box_indices,
+    boxes_soa_t& soa);
+
+void append_frame(boxes_soa_t& boxes, const torch::Tensor& frame_boxes);
+
+void remove_first_frame(boxes_soa_t& boxes);
+
+void find_overlapping_boxes_dense(
+    const boxes_soa_t& boxes,
+    const int& box_idx,
+    const int& frame_idx,
+    const float& iou_threshold,
+    std::vector<int>& overlapping);
+
+void find_overlapping_boxes_indexed(
+    const boxes_soa_t& boxes,
+    const int& box_idx,
+    const int& frame_idx,
+    const float& iou_threshold,
+    std::vector<int>& overlapping);
+
+void find_overlapping_boxes(
+    const boxes_soa_t& boxes,
+    const int& box_idx,
+    const int& frame_idx,
+    const float& iou_threshold,
+    std::vector<int>& overlapping);
+
+void clear_overlap_index(overlap_index_t& index);
+
+void prepare_overlap_index(const boxes_soa_t& boxes, const float& iou_threshold, overlap_index_t& index);
+
+void append_frame(overlap_index_t& index);
+
+void remove_first_frame(overlap_index_t& index);
+
+const frame_overlaps_t& get_frame_overlaps(const boxes_soa_t& boxes, const int& frame_idx, overlap_index_t& index);
+
+int64_t overlap_index_bytes(const overlap_index_t& index);
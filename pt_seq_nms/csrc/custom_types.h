@@ -1,13 +1,34 @@
 #pragma once
+#include <cstdint>
 #include <tuple>
 #include <vector>
 
-typedef std::vector<std::vector<std::vector<int>>> box_seq_t;
+typedef std::vector<std::vector<std::vector<int>>> adjacency_list_t;
 
-typedef std::tuple<float, std::vector<int>> score_indicies;
+struct sequence_state_t {
+    /*
+    The dynamic programming state of find_best_sequence, kept between iterations of seq_nms.
+    Boxes are indexed by BoxGraph::frame_offset(f) + b.
 
-typedef std::vector<score_indicies> score_indicies_list;
+    The DP runs from the last frame backwards, so the predecessor of box [f][b] is the box in frame f + 1
+    which its best path continues to.
+    */
+
+    // best cumulative score of a path starting at the box
+    std::vector<float> path_scores;
+    // index of the box in the next frame on the best path, -1 if the path ends at the box
+    std::vector<int> predecessors;
+    // whether the box is linked from a box in the previous frame, i.e. it can't start a sequence
+    std::vector<uint8_t> has_incoming;
+    // highest scoring sequence start in each frame, (score, box index) where box index is -1 if there is none
+    std::vector<std::tuple<float, int>> frame_best_roots;
+    // scratch for the bitsets of the boxes linked by each task when a frame is relaxed in parallel
+    std::vector<uint64_t> task_incoming;
+};
 
 enum ScoreMetric { avg, max };
 
+// why the extraction of sequences stopped, see seq_nms_limits_t
+enum class StopReason { completed, max_sequences, min_sequence_score, deadline };
+
 const float EPS = 1e-16;
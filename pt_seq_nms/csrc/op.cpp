@@ -1,5 +1,8 @@
 #include <torch/torch.h>
+#include <stdexcept>
 #include "seq_nms.h"
+#include "seq_nms_stream.h"
+#include "seq_nms_workspace.h"
 
 #ifdef _WIN32
 #include <Python.h>
@@ -8,6 +11,216 @@ PyMODINIT_FUNC PyInit_seq_nms(void) {
 }
 #endif
 
+static torch::Tensor seq_nms_meta(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame) {
+    /*
+    The Meta kernel of seq_nms, e.g. for torch.compile. Only the shapes are checked, the updated scores have the shape,
+    type and device of @scores.
+    */
+
+    if ((boxes.dim() != 3) || (boxes.size(2) != 4) || (scores.dim() != 2) || (classes.dim() != 2) ||
+        (scores.size(0) != boxes.size(0)) || (scores.size(1) != boxes.size(1)) ||
+        (classes.size(0) != boxes.size(0)) || (classes.size(1) != boxes.size(1))) {
+        throw std::invalid_argument("Expected boxes with the shape [F, N, 4], and scores and classes with the shape [F, N]");
+    }
+    return torch::empty_like(scores);
+}
+
+static torch::Tensor& seq_nms_out_meta(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    torch::Tensor& out) {
+    /*
+    The Meta kernel of seq_nms.out, see seq_nms_meta.
+    */
+
+    torch::Tensor updated_scores = seq_nms_meta(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metric,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame);
+    out.resize_(updated_scores.sizes());
+    return out;
+}
+
+static torch::Tensor& seq_nms_inplace_meta(
+    const torch::Tensor& boxes,
+    torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    const c10::optional<c10::intrusive_ptr<SeqNmsWorkspace>>& workspace) {
+    /*
+    The Meta kernel of seq_nms_, see seq_nms_meta. Returns @scores.
+    */
+
+    seq_nms_meta(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metric,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame);
+    return scores;
+}
+
+static void seq_nms_async_boxed(const c10::OperatorHandle& op, torch::jit::Stack* stack) {
+    /*
+    The kernel of seq_nms_async. Futures aren't supported as the return type of unboxed kernels, so the arguments are
+    popped from and the future is pushed to the stack.
+    */
+
+    std::vector<c10::IValue> args = torch::jit::pop(*stack, 10);
+    c10::intrusive_ptr<c10::ivalue::Future> future = seq_nms_async(
+        args[0].toTensor(),
+        args[1].toTensor(),
+        args[2].toTensor(),
+        args[3].toDouble(),
+        args[4].toDouble(),
+        args[5].toStringRef(),
+        args[6].toBool(),
+        args[7].toBool(),
+        args[8].toOptional<double>(),
+        args[9].toOptional<int64_t>());
+    torch::jit::push(*stack, std::move(future));
+}
+
 TORCH_LIBRARY(seq_nms, m) {
-    m.def("seq_nms", &seq_nms);
+    // seq_nms has an explicit schema and kernels per dispatch key, so it can be traced by torch.compile. The options
+    // added after metric have defaults, so callers passing only the original arguments keep working
+    m.def(
+        "seq_nms(Tensor boxes, Tensor scores, Tensor classes, float linkage_threshold, float iou_threshold, str metric, "
+        "bool class_aware=False, bool disjoint_sequences=False, float? score_threshold=None, "
+        "int? max_boxes_per_frame=None) -> Tensor");
+    m.def(
+        "seq_nms.out(Tensor boxes, Tensor scores, Tensor classes, float linkage_threshold, float iou_threshold, "
+        "str metric, bool class_aware=False, bool disjoint_sequences=False, float? score_threshold=None, "
+        "int? max_boxes_per_frame=None, *, Tensor(a!) out) -> Tensor(a!)");
+    // returns a future, so its schema can't be inferred and its kernels are boxed, see seq_nms_async_boxed
+    m.def(
+        "seq_nms_async(Tensor boxes, Tensor scores, Tensor classes, float linkage_threshold, float iou_threshold, "
+        "str metric, bool class_aware=False, bool disjoint_sequences=False, float? score_threshold=None, "
+        "int? max_boxes_per_frame=None) -> Future(Tensor)");
+
+    // the other ops also have explicit schemas and kernels per dispatch key, an op defined with only a function would
+    // get a CompositeImplicitAutograd kernel, which can't have a fake implementation and would run on fake tensors.
+    // The fake implementations are registered in pt_seq_nms/_fake.py, except for seq_nms_with_stats and
+    // seq_nms_bounded, which also return a Dict or a str and are eager only. The options have the same defaults as in
+    // seq_nms
+    m.def(
+        "seq_nms_batched(Tensor boxes, Tensor scores, Tensor classes, float linkage_threshold, float iou_threshold, "
+        "str metric, bool class_aware=False, bool disjoint_sequences=False, float? score_threshold=None, "
+        "int? max_boxes_per_frame=None) -> Tensor");
+    m.def(
+        "seq_nms_packed(Tensor boxes, Tensor scores, Tensor classes, Tensor frame_offsets, float linkage_threshold, "
+        "float iou_threshold, str metric, bool class_aware=False, bool disjoint_sequences=False, "
+        "float? score_threshold=None, int? max_boxes_per_frame=None) -> Tensor");
+    m.def(
+        "seq_nms_with_stats(Tensor boxes, Tensor scores, Tensor classes, float linkage_threshold, float iou_threshold, "
+        "str metric, bool class_aware=False, bool disjoint_sequences=False, float? score_threshold=None, "
+        "int? max_boxes_per_frame=None) -> (Tensor, Dict(str, int))");
+    m.def(
+        "seq_nms_with_sequences(Tensor boxes, Tensor scores, Tensor classes, float linkage_threshold, "
+        "float iou_threshold, str metric, bool class_aware=False, bool disjoint_sequences=False, "
+        "float? score_threshold=None, int? max_boxes_per_frame=None) -> (Tensor, Tensor, Tensor, Tensor)");
+    // the chunk parameters have no natural default, so they are keyword only
+    m.def(
+        "seq_nms_chunked(Tensor boxes, Tensor scores, Tensor classes, float linkage_threshold, float iou_threshold, "
+        "str metric, bool class_aware=False, bool disjoint_sequences=False, float? score_threshold=None, "
+        "int? max_boxes_per_frame=None, *, int chunk_size, int chunk_overlap) -> Tensor");
+    m.def(
+        "seq_nms_bounded(Tensor boxes, Tensor scores, Tensor classes, float linkage_threshold, float iou_threshold, "
+        "str metric, bool class_aware=False, bool disjoint_sequences=False, float? score_threshold=None, "
+        "int? max_boxes_per_frame=None, int? max_sequences=None, float? min_sequence_score=None, "
+        "float? deadline_ms=None) -> (Tensor, str)");
+    m.def(
+        "seq_nms_sweep(Tensor boxes, Tensor scores, Tensor classes, float linkage_threshold, float[] iou_thresholds, "
+        "str[] metrics, bool class_aware=False, bool disjoint_sequences=False, float? score_threshold=None, "
+        "int? max_boxes_per_frame=None) -> Tensor");
+
+    m.class_<SeqNmsStream>("SeqNmsStream")
+        .def(torch::init<double, double, std::string, int64_t>())
+        .def("push_frame", &SeqNmsStream::push_frame)
+        .def("flush", &SeqNmsStream::flush)
+        .def("num_pending_frames", &SeqNmsStream::num_pending_frames);
+
+    m.class_<SeqNmsWorkspace>("SeqNmsWorkspace")
+        .def(torch::init<>())
+        .def("num_bytes", &SeqNmsWorkspace::num_bytes)
+        .def("clear", &SeqNmsWorkspace::clear);
+
+    // takes a SeqNmsWorkspace, so it is defined after the class. The schema marks @scores as written to, so the call
+    // isn't treated as functional by torch.compile
+    m.def(
+        "seq_nms_(Tensor boxes, Tensor(a!) scores, Tensor classes, float linkage_threshold, float iou_threshold, "
+        "str metric, bool class_aware=False, bool disjoint_sequences=False, float? score_threshold=None, "
+        "int? max_boxes_per_frame=None, __torch__.torch.classes.seq_nms.SeqNmsWorkspace? workspace=None) -> "
+        "Tensor(a!)");
+}
+
+TORCH_LIBRARY_IMPL(seq_nms, CPU, m) {
+    m.impl("seq_nms", &seq_nms);
+    m.impl("seq_nms.out", &seq_nms_out);
+    m.impl("seq_nms_", &seq_nms_);
+    m.impl("seq_nms_async", torch::CppFunction::makeFromBoxedFunction<&seq_nms_async_boxed>());
+    m.impl("seq_nms_batched", &seq_nms_batched);
+    m.impl("seq_nms_packed", &seq_nms_packed);
+    m.impl("seq_nms_with_stats", &seq_nms_with_stats);
+    m.impl("seq_nms_with_sequences", &seq_nms_with_sequences);
+    m.impl("seq_nms_chunked", &seq_nms_chunked);
+    m.impl("seq_nms_bounded", &seq_nms_bounded);
+    m.impl("seq_nms_sweep", &seq_nms_sweep);
+}
+
+// the kernels copy the boxes to the CPU and the scores back, so they are the same for CUDA tensors
+TORCH_LIBRARY_IMPL(seq_nms, CUDA, m) {
+    m.impl("seq_nms", &seq_nms);
+    m.impl("seq_nms.out", &seq_nms_out);
+    m.impl("seq_nms_", &seq_nms_);
+    m.impl("seq_nms_async", torch::CppFunction::makeFromBoxedFunction<&seq_nms_async_boxed>());
+    m.impl("seq_nms_batched", &seq_nms_batched);
+    m.impl("seq_nms_packed", &seq_nms_packed);
+    m.impl("seq_nms_with_stats", &seq_nms_with_stats);
+    m.impl("seq_nms_with_sequences", &seq_nms_with_sequences);
+    m.impl("seq_nms_chunked", &seq_nms_chunked);
+    m.impl("seq_nms_bounded", &seq_nms_bounded);
+    m.impl("seq_nms_sweep", &seq_nms_sweep);
+}
+
+TORCH_LIBRARY_IMPL(seq_nms, Meta, m) {
+    m.impl("seq_nms", &seq_nms_meta);
+    m.impl("seq_nms.out", &seq_nms_out_meta);
+    m.impl("seq_nms_", &seq_nms_inplace_meta);
 }
@@ -1,76 +1,1157 @@
 #include "seq_nms.h"
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/ThreadLocalState.h>
+#include <ATen/record_function.h>
+#include <c10/core/thread_pool.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <exception>
+#include <limits>
+#include <map>
+#include <numeric>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include "box_utils.h"
 #include "sequence_utils.h"
 
 using namespace torch::indexing;
 
-box_seq_t build_box_sequences(
+static float to_linkage_threshold(const double& linkage_threshold) {
+    /*
+    Returns the smallest float that is >= @linkage_threshold, so comparing a float IOU against it gives the same links as
+    comparing against @linkage_threshold.
+    */
+
+    float linkage_threshold_float = static_cast<float>(linkage_threshold);
+    if (linkage_threshold_float < linkage_threshold) {
+        linkage_threshold_float = std::nextafter(linkage_threshold_float, std::numeric_limits<float>::infinity());
+    }
+    return linkage_threshold_float;
+}
+
+static float get_linkage_threshold(const seq_nms_options_t& options) {
+    /*
+    Returns the linkage threshold the ops link with, options.linkage_threshold rounded to the nearest float. seq_nms
+    has always rounded it before linking, so a float IOU equal to the rounded threshold links, unlike in
+    build_box_sequences, see to_linkage_threshold.
+    */
+
+    return static_cast<float>(options.linkage_threshold);
+}
+
+class PhaseTimer {
+    /*
+    Adds the time from its creation until it goes out of scope to the phase @phase_ns of @stats.
+    Nothing is measured if @stats is nullptr.
+    */
+
+  public:
+    PhaseTimer(seq_nms_stats_t* stats, int64_t seq_nms_stats_t::*phase_ns) : stats_(stats), phase_ns_(phase_ns) {
+        if (stats_ != nullptr) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PhaseTimer() {
+        if (stats_ != nullptr) {
+            auto duration = std::chrono::steady_clock::now() - start_;
+            stats_->*phase_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        }
+    }
+
+  private:
+    seq_nms_stats_t* stats_;
+    int64_t seq_nms_stats_t::*phase_ns_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+class BufferGrowthCounter {
+    /*
+    Adds the number of times the buffers of the extraction loop in @buffers grew to stats.buffer_growths. The
+    capacities are compared after each sequence, so a buffer which grew twice for the same sequence is counted once.
+    Nothing is counted if @stats is nullptr.
+    */
+
+  public:
+    BufferGrowthCounter(const seq_nms_buffers_t& buffers, seq_nms_stats_t* stats) : buffers_(buffers), stats_(stats) {
+        if (stats_ != nullptr) {
+            capacities_ = get_capacities();
+        }
+    }
+
+    void update() {
+        if (stats_ == nullptr) {
+            return;
+        }
+        std::array<size_t, NUM_BUFFERS> capacities = get_capacities();
+        for (int b_idx = 0; b_idx < NUM_BUFFERS; b_idx++) {
+            stats_->buffer_growths += capacities[b_idx] != capacities_[b_idx];
+        }
+        capacities_ = capacities;
+    }
+
+  private:
+    static const int NUM_BUFFERS = 13;
+
+    std::array<size_t, NUM_BUFFERS> get_capacities() const {
+        const sequence_state_t& sequence_state = buffers_.sequence_state;
+        return {
+            sequence_state.path_scores.capacity(),
+            sequence_state.predecessors.capacity(),
+            sequence_state.has_incoming.capacity(),
+            sequence_state.frame_best_roots.capacity(),
+            sequence_state.task_incoming.capacity(),
+            buffers_.sequence.capacity(),
+            buffers_.overlapping.capacity(),
+            buffers_.taken.capacity(),
+            buffers_.taken_nodes.capacity(),
+            buffers_.candidates.capacity(),
+            buffers_.sequence_offsets.capacity(),
+            buffers_.sequence_boxes.capacity(),
+            buffers_.sequence_scores.capacity()};
+    }
+
+    const seq_nms_buffers_t& buffers_;
+    seq_nms_stats_t* stats_;
+    std::array<size_t, NUM_BUFFERS> capacities_;
+};
+
+static void add_stats(seq_nms_stats_t& stats, const seq_nms_stats_t& other) {
+    stats.iterations += other.iterations;
+    stats.edges_built += other.edges_built;
+    stats.edges_deleted += other.edges_deleted;
+    stats.nodes_visited += other.nodes_visited;
+    stats.build_ns += other.build_ns;
+    stats.dp_ns += other.dp_ns;
+    stats.rescore_ns += other.rescore_ns;
+    stats.delete_ns += other.delete_ns;
+    stats.peak_graph_bytes += other.peak_graph_bytes;
+    stats.overlap_index_bytes += other.overlap_index_bytes;
+    stats.buffer_growths += other.buffer_growths;
+}
+
+void link_frames(
+    const boxes_soa_t& boxes,
+    const std::vector<int>& classes,
+    const int& frame_idx,
+    const float& linkage_threshold,
+    std::vector<int>& offsets,
+    std::vector<int>& edges,
+    std::vector<int>& overlapping) {
+    /*
+    Links the boxes in frame @frame_idx to the boxes in frame @frame_idx + 1 of the same class which have an IOU of at
+    least @linkage_threshold. The links are written to @offsets and @edges in CSR layout, see frame_links_t.
+
+    classes has the class of every box in @boxes, in the same order.
+    overlapping is a buffer which can be reused between calls.
+    */
+
+    int frame_offset = boxes.frame_offsets[frame_idx];
+    int next_frame_offset = boxes.frame_offsets[frame_idx + 1];
+
+    offsets.assign(1, 0);
+    edges.clear();
+
+    for (int b_idx = 0; b_idx < next_frame_offset - frame_offset; b_idx++) {
+        int box_class = classes[frame_offset + b_idx];
+
+        // class idx < 0 are considered skip idxs
+        if (box_class >= 0) {
+            overlapping.clear();
+            find_overlapping_boxes(boxes, frame_offset + b_idx, frame_idx + 1, linkage_threshold, overlapping);
+
+            for (int ovr_idx : overlapping) {
+                if (classes[next_frame_offset + ovr_idx] == box_class) {
+                    edges.push_back(ovr_idx);
+                }
+            }
+        }
+
+        offsets.push_back(edges.size());
+    }
+}
+
+static void flatten_classes(const boxes_soa_t& boxes, const torch::Tensor& classes, std::vector<int>& box_classes) {
+    /*
+    Writes the class of every box in @boxes to @box_classes, in the same order.
+
+    classes are expected to have the shape [F, N] and the type int32 or int64.
+    */
+
+    int num_frames = boxes.frame_offsets.size() - 1;
+
+    box_classes.resize(boxes.frame_offsets.back());
+    AT_DISPATCH_INDEX_TYPES(classes.scalar_type(), "flatten_classes", [&] {
+        auto classes_acc = classes.accessor<index_t, 2>();
+
+        for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+            for (int b_idx = 0; b_idx < boxes.frame_offsets[f_idx + 1] - boxes.frame_offsets[f_idx]; b_idx++) {
+                box_classes[boxes.frame_offsets[f_idx] + b_idx] = static_cast<int>(classes_acc[f_idx][b_idx]);
+            }
+        }
+    });
+}
+
+static void link_all_frames(
+    const boxes_soa_t& boxes,
+    const std::vector<int>& box_classes,
+    const float& linkage_threshold,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
+    /*
+    Creates the graph of @boxes in buffers.box_graph, every pair of consecutive frames is linked by link_frames.
+    */
+
+    RECORD_FUNCTION("seq_nms::build_box_sequences", std::vector<c10::IValue>());
+    PhaseTimer timer(stats, &seq_nms_stats_t::build_ns);
+
+    int num_frames = boxes.frame_offsets.size() - 1;
+
+    buffers.frame_sizes.resize(num_frames);
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        buffers.frame_sizes[f_idx] = boxes.frame_offsets[f_idx + 1] - boxes.frame_offsets[f_idx];
+    }
+    BoxGraph& box_graph = buffers.box_graph;
+    box_graph.reset(buffers.frame_sizes);
+    // the index may belong to other boxes now
+    clear_overlap_index(buffers.overlaps);
+
+    // linking a frame pair costs about N * N box comparisons
+    int64_t boxes_per_frame = num_frames > 0 ? boxes.frame_offsets.back() / num_frames : 0;
+    int64_t pair_work = std::max<int64_t>(boxes_per_frame * boxes_per_frame, 1);
+    int64_t grain_size = std::max<int64_t>(at::internal::GRAIN_SIZE / pair_work, 1);
+
+    // every frame pair is linked independently and only writes its own links, so the result does not depend on the threads
+    if (buffers.link_buffers.size() < at::get_num_threads()) {
+        buffers.link_buffers.resize(at::get_num_threads());
+    }
+    at::parallel_for(0, std::max(num_frames - 1, 0), grain_size, [&](int64_t begin, int64_t end) {
+        // CSR buffers for the edges of one frame, reused between the frames of the thread
+        frame_link_buffers_t& link_buffers = buffers.link_buffers[at::get_thread_num()];
+
+        for (int f_idx = begin; f_idx < end; f_idx++) {
+            link_frames(
+                boxes,
+                box_classes,
+                f_idx,
+                linkage_threshold,
+                link_buffers.offsets,
+                link_buffers.edges,
+                link_buffers.overlapping);
+            box_graph.set_frame_links(f_idx, link_buffers.offsets, link_buffers.edges);
+        }
+    });
+
+    if (stats != nullptr) {
+        stats->edges_built += box_graph.num_edges();
+        stats->peak_graph_bytes += box_graph.num_bytes();
+    }
+}
+
+BoxGraph build_box_sequences(const boxes_soa_t& boxes, const torch::Tensor& classes, const double& linkage_threshold) {
+    /*
+    Creates a graph where vertices are object at a given frame and the edges are if they have an IOU higher than
+    @linkage_threshold (two consecutive frames).
+
+    boxes are expected to be in the structure-of-arrays layout, see to_boxes_soa.
+    classes are expected to have the shape [F, N].
+    linkage_threshold is the threshold for linking two objects in consecutive frames.
+    */
+
+    seq_nms_buffers_t buffers;
+    flatten_classes(boxes, classes, buffers.box_classes);
+    link_all_frames(boxes, buffers.box_classes, to_linkage_threshold(linkage_threshold), buffers, nullptr);
+    return std::move(buffers.box_graph);
+}
+
+template <typename F>
+static void parallel_for_largest_first(const std::vector<int64_t>& sizes, const F& fn) {
+    /*
+    Calls @fn(i) for every i in [0, sizes.size()) in parallel, items with a larger size are started first.
+
+    Each worker takes the next item when it is done with its current one, so a large item does not hold up the others.
+    */
+
+    int num_items = sizes.size();
+    std::vector<int> order(num_items);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](const int& a, const int& b) {
+        return sizes[a] > sizes[b];
+    });
+
+    std::atomic<int> next_item{0};
+    int num_workers = std::min<int64_t>(at::get_num_threads(), num_items);
+    at::parallel_for(0, num_workers, 1, [&](int64_t begin, int64_t end) {
+        for (int i = next_item++; i < num_items; i = next_item++) {
+            fn(order[i]);
+        }
+    });
+}
+
+static void clear_sequences(seq_nms_buffers_t& buffers) {
+    buffers.sequence_offsets.assign(1, 0);
+    buffers.sequence_boxes.clear();
+    buffers.sequence_scores.clear();
+}
+
+static void record_sequence(
+    const BoxGraph& box_graph,
+    const torch::Tensor& scores,
+    const std::vector<int>& sequence,
+    const int& sequence_frame_index,
+    seq_nms_buffers_t& buffers) {
+    /*
+    Appends @sequence to the sequences taken in @buffers, it is expected to be rescored already.
+    */
+
+    for (int s_idx = 0; s_idx < sequence.size(); s_idx++) {
+        buffers.sequence_boxes.push_back(box_graph.frame_offset(sequence_frame_index + s_idx) + sequence[s_idx]);
+    }
+    buffers.sequence_offsets.push_back(buffers.sequence_boxes.size());
+    // every box of the sequence has the rescored score
+    buffers.sequence_scores.push_back(scores.accessor<float, 2>()[sequence_frame_index][sequence[0]]);
+}
+
+static void append_sequences(const seq_nms_buffers_t& subset, seq_nms_buffers_t& buffers) {
+    /*
+    Appends the sequences taken in @subset to the sequences of @buffers, the boxes are mapped back through
+    subset.box_indices, see select_boxes.
+    */
+
+    int offset = buffers.sequence_boxes.size();
+    for (int box_idx : subset.sequence_boxes) {
+        buffers.sequence_boxes.push_back(subset.box_indices[box_idx]);
+    }
+    for (int s_idx = 1; s_idx < subset.sequence_offsets.size(); s_idx++) {
+        buffers.sequence_offsets.push_back(offset + subset.sequence_offsets[s_idx]);
+    }
+    buffers.sequence_scores.insert(
+        buffers.sequence_scores.end(), subset.sequence_scores.begin(), subset.sequence_scores.end());
+}
+
+static bool limit_reached(const seq_nms_limits_t& limits, const float& sequence_score, seq_nms_buffers_t& buffers) {
+    /*
+    Checks @limits before a sequence with the cumulative score @sequence_score is taken, buffers holds the sequences
+    taken so far. If a limit is reached, buffers.stop_reason is set to the first one in the order of seq_nms_limits_t.
+    */
+
+    if (limits.max_sequences.has_value() && (static_cast<int64_t>(buffers.sequence_scores.size()) >= *limits.max_sequences)) {
+        buffers.stop_reason = StopReason::max_sequences;
+    } else if (limits.min_sequence_score.has_value() && (sequence_score < *limits.min_sequence_score)) {
+        buffers.stop_reason = StopReason::min_sequence_score;
+    } else if (limits.deadline.has_value() && (std::chrono::steady_clock::now() >= *limits.deadline)) {
+        buffers.stop_reason = StopReason::deadline;
+    }
+    return buffers.stop_reason != StopReason::completed;
+}
+
+ScoreMetric get_score_enum_from_string(const std::string& metric_string) {
+    /*
+    Converts @metric_string to the enum "ScoreMetric".
+    */
+
+    if (metric_string == "avg") {
+        return ScoreMetric::avg;
+    } else if (metric_string == "max") {
+        return ScoreMetric::max;
+    } else {
+        throw std::invalid_argument("Unsupported metric_string");
+    }
+}
+
+static bool has_overlap_index(const float& iou_threshold) {
+    // every box overlaps every other box of its frame at a threshold of 0, so the index would be quadratic in the boxes
+    return iou_threshold > 0;
+}
+
+static void suppress_sequence(
+    const std::vector<int>& sequence,
+    const int& sequence_frame_index,
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    const float& iou_threshold,
+    seq_nms_buffers_t& buffers) {
+    /*
+    Removes the boxes overlapping @sequence from @box_graph, see delete_sequence. The overlaps are looked up in
+    buffers.overlaps if extract_sequences prepared it, otherwise they are computed.
+    */
+
+    if (has_overlap_index(iou_threshold)) {
+        delete_sequence(sequence, sequence_frame_index, boxes, box_graph, buffers.overlaps);
+    } else {
+        delete_sequence(sequence, sequence_frame_index, boxes, box_graph, iou_threshold, buffers.overlapping);
+    }
+}
+
+static void extract_disjoint_sequences(
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    torch::Tensor& scores,
+    const float& iou_threshold,
+    const ScoreMetric& metric,
+    const seq_nms_limits_t& limits,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
+    /*
+    Same as extract_sequences, but takes several sequences per solve of the best paths.
+
+    Every sequence start, i.e. box without a link from the previous frame, is a candidate. The candidates are taken
+    from the highest score down with the same tie-breaking as find_highest_score_sequence, and a candidate is rescored
+    and suppressed right away unless one of its boxes was suppressed by, or is part of, a sequence already taken in
+    this pass. The best paths are only solved again once all candidates were visited, the conflicting ones then get
+    another chance. A pass ends at the first candidate of a single box, since the remaining candidates score lower.
+
+    The first sequence of every pass is the one extract_sequences would take, the later ones may be taken in a
+    different order than extract_sequences, which can change which boxes they suppress. @limits are checked before
+    each sequence which is taken, so a limit stops the extraction in the middle of a pass.
+    */
+
+    int num_frames = box_graph.num_frames();
+    sequence_state_t& sequence_state = buffers.sequence_state;
+    {
+        RECORD_FUNCTION("seq_nms::find_best_sequence", std::vector<c10::IValue>());
+        PhaseTimer timer(stats, &seq_nms_stats_t::dp_ns);
+        init_sequence_state(box_graph, scores, sequence_state);
+    }
+    if (stats != nullptr) {
+        stats->nodes_visited += box_graph.num_nodes();
+    }
+
+    // boxes of the sequences taken in the current pass, they are rescored but not always suppressed (e.g. empty boxes)
+    std::vector<uint8_t>& taken = buffers.taken;
+    std::vector<int>& taken_nodes = buffers.taken_nodes;
+    taken.assign(box_graph.num_nodes(), 0);
+    taken_nodes.clear();
+
+    // a max heap of (score, -frame index, -box index), i.e. highest score first and ties go to the earliest frame and box
+    std::vector<std::tuple<float, int, int>>& candidates = buffers.candidates;
+    std::vector<int>& sequence = buffers.sequence;
+    BufferGrowthCounter growth_counter(buffers, stats);
+
+    while (true) {
+        candidates.clear();
+        for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+            for (int b_idx = 0; b_idx < box_graph.num_boxes(f_idx); b_idx++) {
+                int node_idx = box_graph.frame_offset(f_idx) + b_idx;
+
+                // find_highest_score_sequence only takes a sequence scoring above zero
+                if (!sequence_state.has_incoming[node_idx] && (sequence_state.path_scores[node_idx] > 0.0)) {
+                    candidates.emplace_back(sequence_state.path_scores[node_idx], -f_idx, -b_idx);
+                }
+            }
+        }
+        std::make_heap(candidates.begin(), candidates.end());
+
+        int first_dirty_frame = num_frames;
+        int last_dirty_frame = -1;
+
+        while (!candidates.empty()) {
+            std::pop_heap(candidates.begin(), candidates.end());
+            float sequence_score = std::get<0>(candidates.back());
+            int sequence_frame_index = -std::get<1>(candidates.back());
+            int root_box = -std::get<2>(candidates.back());
+            candidates.pop_back();
+
+            trace_sequence(box_graph, sequence_state, sequence_frame_index, root_box, sequence);
+            if (sequence.size() <= 1) {
+                break;
+            }
+
+            bool conflict = false;
+            for (int s_idx = 0; s_idx < sequence.size(); s_idx++) {
+                int frame_idx = sequence_frame_index + s_idx;
+                conflict = conflict || !box_graph.is_alive(frame_idx, sequence[s_idx]) ||
+                           taken[box_graph.frame_offset(frame_idx) + sequence[s_idx]];
+            }
+            if (conflict) {
+                continue;
+            }
+            // the remaining candidates score lower and the best paths only get worse, so nothing else is taken
+            if (limit_reached(limits, sequence_score, buffers)) {
+                return;
+            }
+
+            {
+                RECORD_FUNCTION("seq_nms::rescore_sequence", std::vector<c10::IValue>());
+                PhaseTimer timer(stats, &seq_nms_stats_t::rescore_ns);
+                rescore_sequence(sequence, scores, sequence_frame_index, sequence_score, metric);
+                record_sequence(box_graph, scores, sequence, sequence_frame_index, buffers);
+            }
+            {
+                RECORD_FUNCTION("seq_nms::delete_sequence", std::vector<c10::IValue>());
+                PhaseTimer timer(stats, &seq_nms_stats_t::delete_ns);
+                suppress_sequence(sequence, sequence_frame_index, boxes, box_graph, iou_threshold, buffers);
+            }
+            if (stats != nullptr) {
+                stats->iterations++;
+            }
+
+            for (int s_idx = 0; s_idx < sequence.size(); s_idx++) {
+                int node_idx = box_graph.frame_offset(sequence_frame_index + s_idx) + sequence[s_idx];
+                taken[node_idx] = 1;
+                taken_nodes.push_back(node_idx);
+            }
+            growth_counter.update();
+
+            // delete_sequence changes the edges from the frame before the sequence up to its last frame
+            first_dirty_frame = std::min(first_dirty_frame, std::max(sequence_frame_index - 1, 0));
+            last_dirty_frame = std::max(last_dirty_frame, sequence_frame_index + static_cast<int>(sequence.size()) - 1);
+        }
+
+        // nothing was taken, i.e. the best sequence is a single box or there is none
+        if (taken_nodes.empty()) {
+            break;
+        }
+
+        for (int node_idx : taken_nodes) {
+            taken[node_idx] = 0;
+        }
+        taken_nodes.clear();
+
+        RECORD_FUNCTION("seq_nms::find_best_sequence", std::vector<c10::IValue>());
+        PhaseTimer timer(stats, &seq_nms_stats_t::dp_ns);
+        int64_t num_visited = update_sequence_state(box_graph, scores, sequence_state, first_dirty_frame, last_dirty_frame);
+        if (stats != nullptr) {
+            stats->nodes_visited += num_visited;
+        }
+        growth_counter.update();
+    }
+}
+
+static void extract_best_sequences(
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    torch::Tensor& scores,
+    const float& iou_threshold,
+    const ScoreMetric& metric,
+    const seq_nms_limits_t& limits,
+    const sequence_state_t* initial_state,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
+    /*
+    Takes one sequence per solve of the best paths, see extract_sequences. If @initial_state is not nullptr, the
+    extraction starts from a copy of it instead of solving the best paths of @box_graph first.
+    */
+
+    sequence_state_t& sequence_state = buffers.sequence_state;
+    if (initial_state != nullptr) {
+        sequence_state = *initial_state;
+    } else {
+        {
+            RECORD_FUNCTION("seq_nms::find_best_sequence", std::vector<c10::IValue>());
+            PhaseTimer timer(stats, &seq_nms_stats_t::dp_ns);
+            init_sequence_state(box_graph, scores, sequence_state);
+        }
+        if (stats != nullptr) {
+            stats->nodes_visited += box_graph.num_nodes();
+        }
+    }
+
+    std::vector<int>& best_sequence = buffers.sequence;
+    BufferGrowthCounter growth_counter(buffers, stats);
+    while (true) {
+        // same as find_best_sequence, but traced into the reused sequence buffer
+        std::tuple<int, int, float> best_root;
+        {
+            RECORD_FUNCTION("seq_nms::find_best_sequence", std::vector<c10::IValue>());
+            PhaseTimer timer(stats, &seq_nms_stats_t::dp_ns);
+            best_root = find_highest_score_sequence(sequence_state.frame_best_roots);
+            trace_sequence(box_graph, sequence_state, std::get<0>(best_root), std::get<1>(best_root), best_sequence);
+        }
+
+        int sequence_frame_index = std::get<0>(best_root);
+        float best_score = std::get<2>(best_root);
+
+        if ((best_sequence.size() <= 1) || limit_reached(limits, best_score, buffers)) {
+            break;
+        }
+
+        {
+            RECORD_FUNCTION("seq_nms::rescore_sequence", std::vector<c10::IValue>());
+            PhaseTimer timer(stats, &seq_nms_stats_t::rescore_ns);
+            rescore_sequence(best_sequence, scores, sequence_frame_index, best_score, metric);
+            record_sequence(box_graph, scores, best_sequence, sequence_frame_index, buffers);
+        }
+        {
+            RECORD_FUNCTION("seq_nms::delete_sequence", std::vector<c10::IValue>());
+            PhaseTimer timer(stats, &seq_nms_stats_t::delete_ns);
+            suppress_sequence(best_sequence, sequence_frame_index, boxes, box_graph, iou_threshold, buffers);
+        }
+
+        // delete_sequence changes the edges from the frame before the sequence up to its last frame
+        int first_dirty_frame = std::max(sequence_frame_index - 1, 0);
+        int last_dirty_frame = sequence_frame_index + static_cast<int>(best_sequence.size()) - 1;
+
+        RECORD_FUNCTION("seq_nms::find_best_sequence", std::vector<c10::IValue>());
+        PhaseTimer timer(stats, &seq_nms_stats_t::dp_ns);
+        int64_t num_visited = update_sequence_state(box_graph, scores, sequence_state, first_dirty_frame, last_dirty_frame);
+        if (stats != nullptr) {
+            stats->iterations++;
+            stats->nodes_visited += num_visited;
+        }
+        growth_counter.update();
+    }
+}
+
+static void extract_sequences(
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    torch::Tensor& scores,
+    const float& iou_threshold,
+    const ScoreMetric& metric,
+    const bool& disjoint_sequences,
+    const seq_nms_limits_t& limits,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
+    /*
+    Same as extract_sequences without @buffers, but keeps the state of the extraction in @buffers. Only the buffers of
+    the best paths, of the suppression and of the sequences taken are used, @box_graph does not need to be
+    buffers.box_graph.
+
+    buffers.overlaps are kept between calls with the same number of frames and iou_threshold, see
+    prepare_overlap_index, so @buffers are expected to be used for the same @boxes until link_all_frames clears them,
+    e.g. by extract_linked_boxes.
+
+    The extraction also stops once one of @limits is reached, buffers.stop_reason is then set to it.
+    */
+
+    int64_t num_edges = stats != nullptr ? box_graph.num_edges() : 0;
+    clear_sequences(buffers);
+    buffers.stop_reason = StopReason::completed;
+
+    // the overlaps of a frame are found the first time a sequence through it is suppressed, and are then only walked
+    if (has_overlap_index(iou_threshold)) {
+        prepare_overlap_index(boxes, iou_threshold, buffers.overlaps);
+    }
+
+    if (disjoint_sequences) {
+        extract_disjoint_sequences(boxes, box_graph, scores, iou_threshold, metric, limits, buffers, stats);
+    } else {
+        extract_best_sequences(boxes, box_graph, scores, iou_threshold, metric, limits, nullptr, buffers, stats);
+    }
+
+    if (stats != nullptr) {
+        stats->edges_deleted += num_edges - box_graph.num_edges();
+        if (has_overlap_index(iou_threshold)) {
+            stats->overlap_index_bytes += overlap_index_bytes(buffers.overlaps);
+        }
+    }
+}
+
+void extract_sequences(
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    torch::Tensor& scores,
+    const float& iou_threshold,
+    const ScoreMetric& metric,
+    const bool& disjoint_sequences,
+    seq_nms_stats_t* stats) {
+    /*
+    Repeatedly takes the highest scoring sequence in @box_graph, rescores it and removes the boxes overlapping it, until
+    no sequence longer than one box is left. @scores are updated in place.
+
+    If @disjoint_sequences is set, several sequences are taken per solve of the best paths, see
+    extract_disjoint_sequences.
+    If @stats is not nullptr, the counters and phase times of the extraction are added to it.
+    */
+
+    seq_nms_buffers_t buffers;
+    extract_sequences(
+        boxes, box_graph, scores, iou_threshold, metric, disjoint_sequences, seq_nms_limits_t(), buffers, stats);
+}
+
+void extract_sequences(
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    torch::Tensor& scores,
+    const sequence_state_t& sequence_state,
+    const float& iou_threshold,
+    const ScoreMetric& metric,
+    seq_nms_buffers_t& buffers) {
+    /*
+    Same as extract_sequences without @buffers, but starts from @sequence_state, the best paths already solved for
+    @box_graph and @scores, e.g. kept up to date frame by frame by SeqNmsStream, instead of solving them first.
+
+    Unlike extract_sequences, buffers.overlaps are not prepared here. They are expected to be prepared for @boxes at
+    @iou_threshold by the caller and kept in sync with the frames of @boxes, see append_frame(index) and
+    remove_first_frame(index).
+    */
+
+    clear_sequences(buffers);
+    buffers.stop_reason = StopReason::completed;
+    extract_best_sequences(
+        boxes, box_graph, scores, iou_threshold, metric, seq_nms_limits_t(), &sequence_state, buffers, nullptr);
+}
+
+static void gather_scores(
+    const boxes_soa_t& boxes,
+    const torch::Tensor& scores,
+    const std::vector<int>& frame_offsets,
+    const std::vector<int>& box_indices,
+    torch::Tensor& selected_scores) {
+    /*
+    Writes the scores of a subset of @boxes to @selected_scores, see select_boxes for @frame_offsets and @box_indices.
+
+    scores are expected to have the shape [F, M], box b of frame f has the score scores[f][b].
+    selected_scores are resized to [F, K], where K is the largest number of selected boxes in a frame, and reuse their
+        memory if they are already large enough. Frames with fewer boxes are padded with zeros.
+    */
+
+    auto scores_acc = scores.accessor<float, 2>();
+    int num_frames = frame_offsets.size() - 1;
+
+    int max_boxes = 0;
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        max_boxes = std::max(max_boxes, frame_offsets[f_idx + 1] - frame_offsets[f_idx]);
+    }
+
+    if (selected_scores.defined()) {
+        selected_scores.resize_({num_frames, max_boxes});
+    } else {
+        selected_scores = torch::empty({num_frames, max_boxes}, torch::kFloat32);
+    }
+
+    auto selected_scores_acc = selected_scores.accessor<float, 2>();
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        int num_selected = frame_offsets[f_idx + 1] - frame_offsets[f_idx];
+
+        for (int i = 0; i < max_boxes; i++) {
+            if (i < num_selected) {
+                int b_idx = box_indices[frame_offsets[f_idx] + i] - boxes.frame_offsets[f_idx];
+                selected_scores_acc[f_idx][i] = scores_acc[f_idx][b_idx];
+            } else {
+                selected_scores_acc[f_idx][i] = 0.0;
+            }
+        }
+    }
+}
+
+static void scatter_scores(
+    const boxes_soa_t& boxes,
+    torch::Tensor& scores,
+    const std::vector<int>& frame_offsets,
+    const std::vector<int>& box_indices,
+    const torch::Tensor& selected_scores) {
+    /*
+    Writes @selected_scores back to @scores, the inverse of gather_scores.
+    */
+
+    auto scores_acc = scores.accessor<float, 2>();
+    auto selected_scores_acc = selected_scores.accessor<float, 2>();
+    int num_frames = frame_offsets.size() - 1;
+
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        for (int i = frame_offsets[f_idx]; i < frame_offsets[f_idx + 1]; i++) {
+            int b_idx = box_indices[i] - boxes.frame_offsets[f_idx];
+            scores_acc[f_idx][b_idx] = selected_scores_acc[f_idx][i - frame_offsets[f_idx]];
+        }
+    }
+}
+
+static std::vector<int64_t> get_class_sizes(const seq_nms_buffers_t& buffers) {
+    // the number of boxes of each class split by link_classes
+    std::vector<int64_t> class_sizes(buffers.class_ids.size());
+    for (int c_idx = 0; c_idx < class_sizes.size(); c_idx++) {
+        class_sizes[c_idx] = buffers.subsets[c_idx].box_indices.size();
+    }
+    return class_sizes;
+}
+
+static void link_classes(
+    const boxes_soa_t& boxes,
+    const std::vector<int>& box_classes,
+    const seq_nms_options_t& options,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
+    /*
+    Splits the boxes by class and links the boxes of each class, the classes are processed in parallel.
+
+    Boxes are only linked to boxes of their own class, so the graph is a disjoint union of one subgraph per class. Each
+    class gets a compact copy of its boxes and its own graph. Boxes with a class < 0 are left out.
+
+    Class c is kept in buffers.subsets[c], see extract_sequences_per_class.
+    */
+
+    int num_frames = boxes.frame_offsets.size() - 1;
+    float linkage_threshold = get_linkage_threshold(options);
+
+    std::vector<int>& class_ids = buffers.class_ids;
+    class_ids.clear();
+    for (int box_class : box_classes) {
+        if (box_class >= 0) {
+            class_ids.push_back(box_class);
+        }
+    }
+    std::sort(class_ids.begin(), class_ids.end());
+    class_ids.erase(std::unique(class_ids.begin(), class_ids.end()), class_ids.end());
+    int num_classes = class_ids.size();
+
+    // the boxes of class c in frame f are box_indices[frame_offsets[f]:frame_offsets[f + 1]] of subset c
+    if (buffers.subsets.size() < num_classes) {
+        buffers.subsets.resize(num_classes);
+    }
+    for (int c_idx = 0; c_idx < num_classes; c_idx++) {
+        buffers.subsets[c_idx].frame_offsets.assign(1, 0);
+        buffers.subsets[c_idx].box_indices.clear();
+    }
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        for (int idx = boxes.frame_offsets[f_idx]; idx < boxes.frame_offsets[f_idx + 1]; idx++) {
+            if (box_classes[idx] >= 0) {
+                int c_idx = std::lower_bound(class_ids.begin(), class_ids.end(), box_classes[idx]) - class_ids.begin();
+                buffers.subsets[c_idx].box_indices.push_back(idx);
+            }
+        }
+        for (int c_idx = 0; c_idx < num_classes; c_idx++) {
+            buffers.subsets[c_idx].frame_offsets.push_back(buffers.subsets[c_idx].box_indices.size());
+        }
+    }
+
+    // every class only writes the stats and buffers of its own boxes
+    std::vector<seq_nms_stats_t> class_stats(stats != nullptr ? num_classes : 0);
+    parallel_for_largest_first(get_class_sizes(buffers), [&](const int& c_idx) {
+        seq_nms_stats_t* c_stats = stats != nullptr ? &class_stats[c_idx] : nullptr;
+        seq_nms_buffers_t& class_buffers = buffers.subsets[c_idx];
+
+        select_boxes(boxes, class_buffers.frame_offsets, class_buffers.box_indices, class_buffers.boxes);
+        class_buffers.box_classes.assign(class_buffers.box_indices.size(), 0);
+        link_all_frames(class_buffers.boxes, class_buffers.box_classes, linkage_threshold, class_buffers, c_stats);
+    });
+
+    for (const seq_nms_stats_t& c_stats : class_stats) {
+        add_stats(*stats, c_stats);
+    }
+}
+
+static void extract_sequences_per_class(
+    const boxes_soa_t& boxes,
+    torch::Tensor& scores,
+    const seq_nms_options_t& options,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
+    /*
+    Applies extract_sequences to the boxes of each class split by link_classes, the classes are processed in parallel.
+
+    Each class is rescored as if the clip only had its boxes, i.e. a sequence only suppresses boxes of its own class.
+    The sequences of the classes are collected in buffers, by class and then in the order they were taken.
+    */
+
+    int num_classes = buffers.class_ids.size();
+
+    // every class only reads and writes the scores, stats and buffers of its own boxes
+    std::vector<seq_nms_stats_t> class_stats(stats != nullptr ? num_classes : 0);
+    parallel_for_largest_first(get_class_sizes(buffers), [&](const int& c_idx) {
+        seq_nms_stats_t* c_stats = stats != nullptr ? &class_stats[c_idx] : nullptr;
+        seq_nms_buffers_t& class_buffers = buffers.subsets[c_idx];
+
+        gather_scores(boxes, scores, class_buffers.frame_offsets, class_buffers.box_indices, class_buffers.scores);
+        extract_sequences(
+            class_buffers.boxes,
+            class_buffers.box_graph,
+            class_buffers.scores,
+            options.iou_threshold,
+            options.metric,
+            options.disjoint_sequences,
+            options.limits,
+            class_buffers,
+            c_stats);
+        scatter_scores(boxes, scores, class_buffers.frame_offsets, class_buffers.box_indices, class_buffers.scores);
+    });
+
+    for (const seq_nms_stats_t& c_stats : class_stats) {
+        add_stats(*stats, c_stats);
+    }
+
+    clear_sequences(buffers);
+    buffers.stop_reason = StopReason::completed;
+    for (int c_idx = 0; c_idx < num_classes; c_idx++) {
+        append_sequences(buffers.subsets[c_idx], buffers);
+        if (buffers.stop_reason == StopReason::completed) {
+            buffers.stop_reason = buffers.subsets[c_idx].stop_reason;
+        }
+    }
+}
+
+static void select_candidates(
+    const boxes_soa_t& boxes,
+    const torch::Tensor& scores,
+    const seq_nms_options_t& options,
+    std::vector<int>& frame_offsets,
+    std::vector<int>& box_indices) {
+    /*
+    Selects the boxes with a score of at least options.score_threshold and then at most options.max_boxes_per_frame of
+    the highest scoring boxes of each frame, see select_boxes for @frame_offsets and @box_indices.
+
+    Ties are resolved to the lowest box index and the selected boxes keep their order. A NaN score is never selected
+    by the threshold and ranks below every other score.
+    */
+
+    auto scores_acc = scores.accessor<float, 2>();
+    int num_frames = boxes.frame_offsets.size() - 1;
+
+    frame_offsets.assign(1, 0);
+    box_indices.clear();
+
+    std::vector<int> frame_boxes;
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        frame_boxes.clear();
+        for (int b_idx = 0; b_idx < boxes.frame_offsets[f_idx + 1] - boxes.frame_offsets[f_idx]; b_idx++) {
+            if (!options.score_threshold.has_value() || (scores_acc[f_idx][b_idx] >= *options.score_threshold)) {
+                frame_boxes.push_back(b_idx);
+            }
+        }
+
+        if (options.max_boxes_per_frame.has_value() && (frame_boxes.size() > *options.max_boxes_per_frame)) {
+            auto score_key = [&](const int& b_idx) {
+                float score = scores_acc[f_idx][b_idx];
+                return std::isnan(score) ? -std::numeric_limits<float>::infinity() : score;
+            };
+            std::stable_sort(frame_boxes.begin(), frame_boxes.end(), [&](const int& a, const int& b) {
+                return score_key(a) > score_key(b);
+            });
+            frame_boxes.resize(*options.max_boxes_per_frame);
+            std::sort(frame_boxes.begin(), frame_boxes.end());
+        }
+
+        for (int b_idx : frame_boxes) {
+            box_indices.push_back(boxes.frame_offsets[f_idx] + b_idx);
+        }
+        frame_offsets.push_back(box_indices.size());
+    }
+}
+
+static bool has_pruning(const seq_nms_options_t& options) {
+    return options.score_threshold.has_value() || options.max_boxes_per_frame.has_value();
+}
+
+static seq_nms_options_t without_pruning(const seq_nms_options_t& options) {
+    // the options of the selected candidates, which are all rescored
+    seq_nms_options_t selected_options = options;
+    selected_options.score_threshold = c10::nullopt;
+    selected_options.max_boxes_per_frame = c10::nullopt;
+    return selected_options;
+}
+
+static void link_boxes(
+    const boxes_soa_t& boxes,
+    const std::vector<int>& box_classes,
+    const torch::Tensor& scores,
+    const seq_nms_options_t& options,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
+    /*
+    Selects the candidates and builds the graphs of rescore_boxes in @buffers, see there for the arguments. @scores are
+    only read to select the candidates.
+
+    The graphs don't depend on options.iou_threshold, options.metric or the limits, so they can be extracted from several
+    times with different ones, see extract_linked_boxes and BoxGraph::restore_boxes.
+    */
+
+    if (has_pruning(options)) {
+        if (buffers.subsets.empty()) {
+            buffers.subsets.resize(1);
+        }
+        seq_nms_buffers_t& selected = buffers.subsets[0];
+
+        select_candidates(boxes, scores, options, selected.frame_offsets, selected.box_indices);
+        select_boxes(boxes, selected.frame_offsets, selected.box_indices, selected.boxes);
+        selected.box_classes.resize(selected.box_indices.size());
+        for (int i = 0; i < selected.box_indices.size(); i++) {
+            selected.box_classes[i] = box_classes[selected.box_indices[i]];
+        }
+
+        link_boxes(selected.boxes, selected.box_classes, scores, without_pruning(options), selected, stats);
+    } else if (options.class_aware) {
+        link_classes(boxes, box_classes, options, buffers, stats);
+    } else {
+        link_all_frames(boxes, box_classes, get_linkage_threshold(options), buffers, stats);
+    }
+}
+
+static void extract_linked_boxes(
+    const boxes_soa_t& boxes,
+    torch::Tensor& scores,
+    const seq_nms_options_t& options,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
+    /*
+    Extracts the sequences from the graphs link_boxes built in @buffers with the same @boxes and @options, updating
+    @scores in place, see rescore_boxes.
+    */
+
+    if (has_pruning(options)) {
+        seq_nms_buffers_t& selected = buffers.subsets[0];
+
+        gather_scores(boxes, scores, selected.frame_offsets, selected.box_indices, selected.scores);
+        extract_linked_boxes(selected.boxes, selected.scores, without_pruning(options), selected, stats);
+        scatter_scores(boxes, scores, selected.frame_offsets, selected.box_indices, selected.scores);
+
+        clear_sequences(buffers);
+        append_sequences(selected, buffers);
+        buffers.stop_reason = selected.stop_reason;
+    } else if (options.class_aware) {
+        extract_sequences_per_class(boxes, scores, options, buffers, stats);
+    } else {
+        extract_sequences(
+            boxes,
+            buffers.box_graph,
+            scores,
+            options.iou_threshold,
+            options.metric,
+            options.disjoint_sequences,
+            options.limits,
+            buffers,
+            stats);
+    }
+}
+
+static void rescore_boxes(
+    const boxes_soa_t& boxes,
+    const std::vector<int>& box_classes,
+    torch::Tensor& scores,
+    const seq_nms_options_t& options,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
+    /*
+    Applies the seq-nms algorithm to the clip @boxes, updating @scores in place.
+
+    box_classes has the class of every box in @boxes, in the same order.
+    scores are expected to have the shape [F, M], box b of frame f has the score scores[f][b]. M can be larger than
+        the number of boxes in a frame, the remaining scores are not used.
+    If a score threshold or a maximum number of boxes per frame is set, only the selected boxes are rescored, see
+        select_candidates. The other boxes keep their scores and don't take part in linking or suppression. The
+        selected boxes are kept in buffers.subsets[0].
+    If options.class_aware is set the classes are rescored separately, see extract_sequences_per_class.
+    buffers are the working memory of the call, see seq_nms_buffers_t. The sequences taken are left in buffers, with the
+        boxes as indices into @boxes.
+    If @stats is not nullptr, the counters and phase times are added to it.
+    */
+
+    link_boxes(boxes, box_classes, scores, options, buffers, stats);
+    extract_linked_boxes(boxes, scores, options, buffers, stats);
+}
+
+void rescore_clip(
+    const torch::Tensor& boxes,
+    torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const seq_nms_options_t& options,
+    seq_nms_stats_t* stats) {
+    /*
+    Applies the seq-nms algorithm to one clip, updating @scores in place, see rescore_boxes.
+
+    boxes, scores and classes are expected to be CPU tensors with the shapes [F, N, 4], [F, N] and [F, N].
+        Boxes can have any floating point type, scores are expected to be float32 and classes int32 or int64.
+    */
+
+    seq_nms_buffers_t buffers;
+    rescore_clip(boxes, scores, classes, options, buffers, stats);
+}
+
+void rescore_clip(
     const torch::Tensor& boxes,
-    const torch::Tensor& box_areas,
+    torch::Tensor& scores,
     const torch::Tensor& classes,
-    const double& linkage_threshold) {
+    const seq_nms_options_t& options,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats) {
     /*
-    Creates a graph where vertices are object at a given frame and the edges are if they have an IOU higher than
-    @linkage_threshold (two consecutive frames).
-
-    boxes are expected to have the shape [F, N, 4] and of the format [x_min, y_min, x_max, y_max].
-        F is the number of frames and N is the number of objects per frame.
-    classes are expected to have the shape [F, N].
-    linkage_threshold is the threshold for linking two objects in consecutive frames.
+    Same as rescore_clip without @buffers, but uses @buffers as the working memory of the call, see seq_nms_buffers_t.
     */
 
-    auto classes_acc = classes.accessor<int, 2>();
+    to_boxes_soa(boxes, buffers.boxes);
+    flatten_classes(buffers.boxes, classes, buffers.box_classes);
+    rescore_boxes(buffers.boxes, buffers.box_classes, scores, options, buffers, stats);
+}
+
+void rescore_packed_clip(
+    const torch::Tensor& boxes,
+    torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const std::vector<int>& frame_offsets,
+    const seq_nms_options_t& options,
+    seq_nms_buffers_t& buffers) {
+    /*
+    Applies the seq-nms algorithm to one clip packed frame after frame, updating @scores in place, see seq_nms_packed.
 
-    box_seq_t box_graph;
-    for (int f_idx = 0; f_idx < boxes.size(0) - 1; f_idx++) {
-        auto current_box = boxes.index({f_idx, Slice(), Slice()});
-        auto current_area = box_areas.index({f_idx, Slice()});
+    boxes, scores and classes are expected to be CPU tensors with the shapes [S, 4], [S] and [S].
+        Boxes can have any floating point type, scores are expected to be float32 and classes int32 or int64.
+    frame_offsets are expected to be valid, the boxes of frame f are boxes[frame_offsets[f]:frame_offsets[f + 1]].
+    buffers are the working memory of the call, see seq_nms_buffers_t.
+    */
 
-        auto next_box = boxes.index({f_idx + 1, Slice(), Slice()});
-        auto next_area = box_areas.index({f_idx + 1, Slice()});
+    int num_frames = frame_offsets.size() - 1;
+    int num_boxes = frame_offsets.back();
 
-        // overlap has shape [N, N]
-        auto overlaps = calculate_iou_given_area(current_box, next_box, current_area, next_area);
-        auto overlaps_acc = overlaps.accessor<float, 2>();
+    int max_boxes = 0;
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        max_boxes = std::max(max_boxes, frame_offsets[f_idx + 1] - frame_offsets[f_idx]);
+    }
 
-        std::vector<std::vector<int>> adjacency_matrix;
-        for (int b_idx = 0; b_idx < current_box.size(0); b_idx++) {
-            std::vector<int> edges;
-            for (int ovr_idx = 0; ovr_idx < overlaps.size(1); ovr_idx++) {
-                float iou = overlaps_acc[b_idx][ovr_idx];
-                bool same_class = (classes_acc[f_idx][b_idx] == classes_acc[f_idx + 1][ovr_idx]);
+    to_boxes_soa(boxes, frame_offsets, buffers.boxes);
 
-                // class idx < 0 are considered skip idxs
-                bool accepted_class = (classes_acc[f_idx][b_idx] >= 0);
+    buffers.box_classes.resize(num_boxes);
+    AT_DISPATCH_INDEX_TYPES(classes.scalar_type(), "rescore_packed_clip", [&] {
+        auto classes_acc = classes.accessor<index_t, 1>();
 
-                if ((iou >= linkage_threshold) && same_class && accepted_class) {
-                    edges.push_back(ovr_idx);
-                }
-            }
+        for (int idx = 0; idx < num_boxes; idx++) {
+            buffers.box_classes[idx] = static_cast<int>(classes_acc[idx]);
+        }
+    });
 
-            adjacency_matrix.push_back(edges);
+    // the DP indexes scores by frame, only the scores are padded and the padding is not part of the graph
+    if (buffers.scores.defined()) {
+        buffers.scores.resize_({num_frames, max_boxes});
+    } else {
+        buffers.scores = torch::empty({num_frames, max_boxes}, torch::kFloat32);
+    }
+    auto scores_acc = scores.accessor<float, 1>();
+    auto frame_scores_acc = buffers.scores.accessor<float, 2>();
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        for (int i = 0; i < max_boxes; i++) {
+            int idx = frame_offsets[f_idx] + i;
+            frame_scores_acc[f_idx][i] = idx < frame_offsets[f_idx + 1] ? scores_acc[idx] : 0.0f;
         }
-        box_graph.push_back(adjacency_matrix);
     }
 
-    return box_graph;
+    rescore_boxes(buffers.boxes, buffers.box_classes, buffers.scores, options, buffers, nullptr);
+
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        for (int idx = frame_offsets[f_idx]; idx < frame_offsets[f_idx + 1]; idx++) {
+            scores_acc[idx] = frame_scores_acc[f_idx][idx - frame_offsets[f_idx]];
+        }
+    }
 }
 
-ScoreMetric get_score_enum_from_string(const std::string& metric_string) {
+seq_nms_options_t to_seq_nms_options(
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame) {
     /*
-    Converts @metric_string to the enum "ScoreMetric".
+    Validates the arguments shared by the seq_nms ops and collects them in a seq_nms_options_t.
     */
 
-    if (metric_string == "avg") {
-        return ScoreMetric::avg;
-    } else if (metric_string == "max") {
-        return ScoreMetric::max;
-    } else {
-        throw std::invalid_argument("Unsupported metric_string");
+    if (max_boxes_per_frame.has_value() && (*max_boxes_per_frame < 0)) {
+        throw std::invalid_argument("max_boxes_per_frame is expected to be >= 0");
     }
+
+    seq_nms_options_t options;
+    options.linkage_threshold = linkage_threshold;
+    options.iou_threshold = static_cast<float>(iou_threshold);
+    options.metric = get_score_enum_from_string(metric);
+    options.class_aware = class_aware;
+    options.disjoint_sequences = disjoint_sequences;
+    options.score_threshold = score_threshold;
+    options.max_boxes_per_frame = max_boxes_per_frame;
+    return options;
 }
 
 torch::Tensor seq_nms(
@@ -79,7 +1160,11 @@ torch::Tensor seq_nms(
     const torch::Tensor& classes,
     const double& linkage_threshold,
     const double& iou_threshold,
-    const std::string& metric) {
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame) {
     /*
     Applies the seq-nms algorithm to the input boxes.
 
@@ -87,40 +1172,696 @@ torch::Tensor seq_nms(
         F is the number of frames and N is the number of objects per frame.
     scores are expected to have the shape [F, N].
     classes are expected to have the shape [F, N].
+        Boxes and scores can be float16, bfloat16, float32 or float64 and classes int32 or int64. Boxes and classes are
+        read as they are, IOUs are computed and scores rescored in float32. The returned scores have the type of @scores.
     linkage_threshold is the threshold for linking two objects in consecutive frames.
     iou_threshold is the threshold for considering two boxes to be overlapping.
     metric is the metric type, currently "avg" and "max" is supported.
+    class_aware is whether a sequence only suppresses boxes of its own class, the classes are then processed in parallel.
+        Otherwise a sequence suppresses the overlapping boxes of every class.
+    disjoint_sequences is whether every sequence which doesn't conflict with a higher scoring one is taken before the
+        best paths are solved again. This needs far fewer solves on clips with many independent objects, but sequences
+        can be taken in a different order, see extract_disjoint_sequences.
+    score_threshold is the lowest score of a box taking part in seq-nms, if set.
+    max_boxes_per_frame is the number of highest scoring boxes of each frame taking part in seq-nms, if set.
+        Boxes left out by either keep their scores.
     */
 
-    ScoreMetric metric_enum = get_score_enum_from_string(metric);
-    float linkage_threshold_float = static_cast<float>(linkage_threshold);
-    float iou_threshold_float = static_cast<float>(iou_threshold);
+    seq_nms_options_t options = to_seq_nms_options(
+        linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
+
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+    // the scores are rescored in float32 whatever their type, the copy is needed anyway since they are updated in place
+    torch::Tensor local_scores = scores.to(torch::kCPU, torch::kFloat32, /*non_blocking=*/false, /*copy=*/true);
+
+    rescore_clip(boxes_cpu, local_scores, classes_cpu, options, nullptr);
+
+    local_scores = local_scores.to(scores.device(), scores.scalar_type());
+    return local_scores;
+}
+
+torch::Tensor& seq_nms_out(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    torch::Tensor& out) {
+    /*
+    Same as seq_nms, but writes the updated scores to @out, which is resized to the shape of @scores. The scores are
+    converted to the type and device of @out. Returns @out.
+    */
+
+    torch::Tensor updated_scores = seq_nms(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metric,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame);
+    out.resize_(updated_scores.sizes());
+    out.copy_(updated_scores);
+    return out;
+}
+
+torch::Tensor seq_nms_batched(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame) {
+    /*
+    Applies the seq-nms algorithm to a batch of clips, the clips are processed in parallel.
+
+    boxes are expected to have the shape [B, F, N, 4] and of the format [x_min, y_min, x_max, y_max].
+        B is the number of clips, F is the number of frames and N is the number of objects per frame.
+    scores are expected to have the shape [B, F, N].
+    classes are expected to have the shape [B, F, N].
+    The remaining arguments are the same as for seq_nms.
+
+    The returned scores have the shape [B, F, N], clip b is the same as seq_nms on boxes[b], scores[b] and classes[b].
+    */
 
-    torch::Tensor box_areas = calculate_area(boxes);
-    box_areas = box_areas.to(torch::kCPU);
+    seq_nms_options_t options = to_seq_nms_options(
+        linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
 
     const auto boxes_cpu = boxes.to(torch::kCPU);
     const auto classes_cpu = classes.to(torch::kCPU);
+    // the scores are rescored in float32 whatever their type, the copy is needed anyway since they are updated in place
+    torch::Tensor local_scores = scores.to(torch::kCPU, torch::kFloat32, /*non_blocking=*/false, /*copy=*/true);
 
-    box_seq_t box_graph = build_box_sequences(boxes_cpu, box_areas, classes_cpu, linkage_threshold_float);
-    torch::Tensor local_scores = scores.to(torch::kCPU).clone();
+    // clips with padding (class < 0) are cheaper, start with the clips that have the most boxes to balance the load
+    int num_clips = boxes_cpu.size(0);
+    std::vector<int64_t> clip_sizes(num_clips, 0);
+    AT_DISPATCH_INDEX_TYPES(classes_cpu.scalar_type(), "seq_nms_batched", [&] {
+        auto classes_acc = classes_cpu.accessor<index_t, 3>();
 
-    while (true) {
-        auto best_tuple = find_best_sequence(box_graph, local_scores);
+        for (int c_idx = 0; c_idx < num_clips; c_idx++) {
+            for (int f_idx = 0; f_idx < classes_acc.size(1); f_idx++) {
+                for (int b_idx = 0; b_idx < classes_acc.size(2); b_idx++) {
+                    clip_sizes[c_idx] += classes_acc[c_idx][f_idx][b_idx] >= 0;
+                }
+            }
+        }
+    });
 
-        int sequence_frame_index = std::get<0>(best_tuple);
-        std::vector<int> best_sequence = std::get<1>(best_tuple);
-        float best_score = std::get<2>(best_tuple);
+    parallel_for_largest_first(clip_sizes, [&](const int& clip_idx) {
+        torch::Tensor clip_scores = local_scores[clip_idx];
+        rescore_clip(boxes_cpu[clip_idx], clip_scores, classes_cpu[clip_idx], options, nullptr);
+    });
 
-        if (best_sequence.size() <= 1) {
-            break;
+    local_scores = local_scores.to(scores.device(), scores.scalar_type());
+    return local_scores;
+}
+
+torch::Tensor seq_nms_packed(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const torch::Tensor& frame_offsets,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame) {
+    /*
+    Applies the seq-nms algorithm to boxes packed frame after frame, frames can have different numbers of boxes.
+
+    boxes are expected to have the shape [S, 4] and of the format [x_min, y_min, x_max, y_max].
+        S is the total number of boxes over all frames.
+    scores are expected to have the shape [S].
+    classes are expected to have the shape [S].
+    frame_offsets are expected to have the shape [F + 1], the boxes of frame f are boxes[frame_offsets[f]:frame_offsets[f + 1]].
+        F is the number of frames, frame_offsets[0] is 0 and frame_offsets[F] is S.
+    The remaining arguments are the same as for seq_nms.
+
+    The returned scores have the shape [S] and are the same as seq_nms with every frame padded to the same length.
+    */
+
+    seq_nms_options_t options = to_seq_nms_options(
+        linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
+
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+    const auto frame_offsets_cpu = frame_offsets.to(torch::kCPU);
+    // the scores are rescored in float32 whatever their type, the copy is needed anyway since they are updated in place
+    torch::Tensor local_scores = scores.to(torch::kCPU, torch::kFloat32, /*non_blocking=*/false, /*copy=*/true);
+
+    int num_boxes = boxes_cpu.size(0);
+    int num_frames = frame_offsets_cpu.size(0) - 1;
+    auto frame_offsets_acc = frame_offsets_cpu.accessor<int64_t, 1>();
+
+    if ((local_scores.size(0) != num_boxes) || (classes_cpu.size(0) != num_boxes)) {
+        throw std::invalid_argument("boxes, scores and classes are expected to have the same number of boxes");
+    }
+    if ((num_frames < 0) || (frame_offsets_acc[0] != 0) || (frame_offsets_acc[num_frames] != num_boxes)) {
+        throw std::invalid_argument("frame_offsets are expected to start at 0 and end at the number of boxes");
+    }
+
+    std::vector<int> offsets(num_frames + 1);
+    for (int f_idx = 0; f_idx <= num_frames; f_idx++) {
+        offsets[f_idx] = frame_offsets_acc[f_idx];
+
+        if ((f_idx > 0) && (offsets[f_idx] < offsets[f_idx - 1])) {
+            throw std::invalid_argument("frame_offsets are expected to be non-decreasing");
+        }
+    }
+
+    seq_nms_buffers_t buffers;
+    rescore_packed_clip(boxes_cpu, local_scores, classes_cpu, offsets, options, buffers);
+
+    local_scores = local_scores.to(scores.device(), scores.scalar_type());
+    return local_scores;
+}
+
+std::tuple<torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor> seq_nms_with_sequences(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame) {
+    /*
+    Same as seq_nms, but also returns the sequences which were rescored, so they can be used as tracks.
+
+    Returns the updated scores [F, N], the sequence ids [F, N], the sequence scores [S] and the sequence lengths [S].
+        S is the number of sequences, numbered in the order they were taken (by class first if @class_aware is set).
+        The sequence id of a box is the sequence it was rescored by, or -1 if it is in none, e.g. a suppressed box.
+        A box which is in several sequences, which is only possible for a box that is never suppressed such as an
+        empty box, gets the last one, same as its score.
+        The score of a sequence is the score its boxes were rescored to and its length the number of its boxes.
+        Sequence ids and lengths are int64, the sequence scores have the type of @scores.
+    */
+
+    seq_nms_options_t options = to_seq_nms_options(
+        linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
+
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+    // the scores are rescored in float32 whatever their type, the copy is needed anyway since they are updated in place
+    torch::Tensor local_scores = scores.to(torch::kCPU, torch::kFloat32, /*non_blocking=*/false, /*copy=*/true);
+
+    seq_nms_buffers_t buffers;
+    rescore_clip(boxes_cpu, local_scores, classes_cpu, options, buffers, nullptr);
+
+    const std::vector<int>& frame_offsets = buffers.boxes.frame_offsets;
+    int num_sequences = buffers.sequence_scores.size();
+
+    torch::Tensor sequence_ids = torch::full({local_scores.size(0), local_scores.size(1)}, -1, torch::kInt64);
+    torch::Tensor sequence_scores = torch::empty({num_sequences}, torch::kFloat32);
+    torch::Tensor sequence_lengths = torch::empty({num_sequences}, torch::kInt64);
+    auto sequence_ids_acc = sequence_ids.accessor<int64_t, 2>();
+    auto sequence_scores_acc = sequence_scores.accessor<float, 1>();
+    auto sequence_lengths_acc = sequence_lengths.accessor<int64_t, 1>();
+
+    for (int s_idx = 0; s_idx < num_sequences; s_idx++) {
+        for (int i = buffers.sequence_offsets[s_idx]; i < buffers.sequence_offsets[s_idx + 1]; i++) {
+            int box_idx = buffers.sequence_boxes[i];
+            int f_idx = std::upper_bound(frame_offsets.begin(), frame_offsets.end(), box_idx) - frame_offsets.begin() - 1;
+            sequence_ids_acc[f_idx][box_idx - frame_offsets[f_idx]] = s_idx;
+        }
+        sequence_scores_acc[s_idx] = buffers.sequence_scores[s_idx];
+        sequence_lengths_acc[s_idx] = buffers.sequence_offsets[s_idx + 1] - buffers.sequence_offsets[s_idx];
+    }
+
+    local_scores = local_scores.to(scores.device(), scores.scalar_type());
+    sequence_ids = sequence_ids.to(scores.device());
+    sequence_scores = sequence_scores.to(scores.device(), scores.scalar_type());
+    sequence_lengths = sequence_lengths.to(scores.device());
+    return std::make_tuple(local_scores, sequence_ids, sequence_scores, sequence_lengths);
+}
+
+struct chunk_track_t {
+    /*
+    A sequence of a chunked clip, see seq_nms_chunked. Box boxes[i] is in frame first_frame + i.
+    */
+
+    int first_frame;
+    std::vector<int> boxes;
+    // the score the chunk rescored the sequence to, only used if the track is that whole sequence
+    float score;
+    bool whole;
+};
+
+static void rescore_track(
+    const chunk_track_t& track,
+    const torch::Tensor& original_scores,
+    torch::Tensor& updated_scores,
+    const ScoreMetric& metric) {
+    /*
+    Writes the score of @track to its boxes in @updated_scores. A whole sequence of one chunk keeps the score the chunk
+    rescored it to, a stitched or cut one is rescored from @original_scores in the same order as rescore_sequence.
+    */
+
+    auto original_acc = original_scores.accessor<float, 2>();
+    auto updated_acc = updated_scores.accessor<float, 2>();
+    int length = track.boxes.size();
+
+    float score = track.score;
+    if (!track.whole) {
+        if (metric == ScoreMetric::avg) {
+            // the best path sums from the last frame to the first
+            float sum = original_acc[track.first_frame + length - 1][track.boxes[length - 1]];
+            for (int i = length - 2; i >= 0; i--) {
+                sum = original_acc[track.first_frame + i][track.boxes[i]] + sum;
+            }
+            score = sum / static_cast<float>(length);
+        } else {
+            score = 0.0;
+            for (int i = 0; i < length; i++) {
+                score = std::max(score, original_acc[track.first_frame + i][track.boxes[i]]);
+            }
+        }
+    }
+
+    for (int i = 0; i < length; i++) {
+        updated_acc[track.first_frame + i][track.boxes[i]] = score;
+    }
+}
+
+torch::Tensor seq_nms_chunked(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    const int64_t& chunk_size,
+    const int64_t& chunk_overlap) {
+    /*
+    Same as seq_nms, but the clip is processed in chunks of @chunk_size frames, each one overlapping the one before it
+    by @chunk_overlap frames. Only one chunk is rescored at a time, so apart from the input and the returned scores the
+    memory is that of a chunk, plus the boxes of the sequences crossing the current chunk boundary.
+
+    Each chunk decides the scores of the frames between the middles of its overlaps with its neighbours. A sequence
+    of a chunk crossing the middle of the overlap with the next chunk is stitched to the sequence of the next chunk
+    which has the same two boxes on either side of it, and the stitched sequence is rescored as one. This needs a
+    @chunk_overlap of at least 2.
+
+    Deviation from seq_nms:
+        The scores are the same if the clip has at most @chunk_size frames.
+        Otherwise every frame is rescored with at least @chunk_overlap / 2 frames of context on either side. Sequences
+        are taken greedily and seq-nms stops once the best remaining sequence is a single box, both of which depend on
+        the whole clip. So the scores can differ near a chunk boundary whenever the best sequences of the clip interact
+        over more than @chunk_overlap / 2 frames, and a chunk can stop before or after the whole clip would have.
+    */
+
+    seq_nms_options_t options = to_seq_nms_options(
+        linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
+    if (chunk_size < 1) {
+        throw std::invalid_argument("chunk_size should be >= 1");
+    }
+    if ((chunk_overlap < 0) || (chunk_overlap >= chunk_size)) {
+        throw std::invalid_argument("chunk_overlap should be >= 0 and < chunk_size");
+    }
+
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+    // stitched sequences are rescored from the original scores, so the updated ones are written to a copy
+    const torch::Tensor original_scores = scores.to(torch::kCPU, torch::kFloat32);
+    torch::Tensor local_scores = original_scores.clone();
+
+    int num_frames = boxes_cpu.size(0);
+    int stride = chunk_size - chunk_overlap;
+    int half_overlap = chunk_overlap / 2;
+
+    seq_nms_buffers_t buffers;
+    // the tracks crossing the boundary into the current chunk, keyed by their boxes on either side of it
+    std::vector<chunk_track_t> open_tracks;
+    std::map<std::pair<int, int>, int> open_keys;
+    std::vector<chunk_track_t> next_open_tracks;
+    std::map<std::pair<int, int>, int> next_open_keys;
+
+    bool last_chunk = num_frames == 0;
+    for (int chunk_begin = 0; !last_chunk; chunk_begin += stride) {
+        int chunk_end = std::min<int>(chunk_begin + chunk_size, num_frames);
+        last_chunk = chunk_end == num_frames;
+        // the frames this chunk decides the scores of
+        int own_begin = (chunk_begin == 0) ? 0 : chunk_begin + half_overlap;
+        int own_end = last_chunk ? num_frames : chunk_begin + stride + half_overlap;
+
+        torch::Tensor chunk_scores = original_scores.narrow(0, chunk_begin, chunk_end - chunk_begin).clone();
+        rescore_clip(
+            boxes_cpu.narrow(0, chunk_begin, chunk_end - chunk_begin),
+            chunk_scores,
+            classes_cpu.narrow(0, chunk_begin, chunk_end - chunk_begin),
+            options,
+            buffers,
+            nullptr);
+
+        const std::vector<int>& frame_offsets = buffers.boxes.frame_offsets;
+        for (int s_idx = 0; s_idx + 1 < buffers.sequence_offsets.size(); s_idx++) {
+            const int* sequence_boxes = buffers.sequence_boxes.data() + buffers.sequence_offsets[s_idx];
+            int sequence_length = buffers.sequence_offsets[s_idx + 1] - buffers.sequence_offsets[s_idx];
+            int sequence_begin = chunk_begin +
+                                 (std::upper_bound(frame_offsets.begin(), frame_offsets.end(), sequence_boxes[0]) -
+                                  frame_offsets.begin() - 1);
+            int sequence_end = sequence_begin + sequence_length;
+            // the box of the sequence in frame f_idx of the clip
+            auto box_at = [&](const int& f_idx) {
+                return sequence_boxes[f_idx - sequence_begin] - frame_offsets[f_idx - chunk_begin];
+            };
+
+            int begin = std::max(sequence_begin, own_begin);
+            int end = std::min(sequence_end, own_end);
+            if (begin >= end) {
+                // the frames of the sequence are decided by a neighbour
+                continue;
+            }
+
+            chunk_track_t track;
+            auto open_key = open_keys.end();
+            if (begin > sequence_begin) {
+                open_key = open_keys.find({box_at(begin - 1), box_at(begin)});
+            }
+            if (open_key != open_keys.end()) {
+                track = std::move(open_tracks[open_key->second]);
+                open_keys.erase(open_key);
+            } else {
+                track.first_frame = begin;
+                track.score = buffers.sequence_scores[s_idx];
+                track.whole = (begin == sequence_begin) && (end == sequence_end);
+            }
+            for (int f_idx = begin; f_idx < end; f_idx++) {
+                track.boxes.push_back(box_at(f_idx));
+            }
+
+            if (end < sequence_end) {
+                // only boxes which are never suppressed, e.g. empty ones, can be in two sequences, the last one wins
+                int track_idx = next_open_tracks.size();
+                auto inserted = next_open_keys.insert({{box_at(end - 1), box_at(end)}, track_idx});
+                if (!inserted.second) {
+                    rescore_track(next_open_tracks[inserted.first->second], original_scores, local_scores, options.metric);
+                    inserted.first->second = track_idx;
+                }
+                next_open_tracks.push_back(std::move(track));
+            } else {
+                rescore_track(track, original_scores, local_scores, options.metric);
+            }
         }
 
-        rescore_sequence(best_sequence, local_scores, sequence_frame_index, best_score, metric_enum);
-        delete_sequence(
-            best_sequence, sequence_frame_index, local_scores, boxes_cpu, box_areas, box_graph, iou_threshold_float);
+        // the tracks which the chunk didn't continue end at the boundary
+        for (const auto& open_key : open_keys) {
+            rescore_track(open_tracks[open_key.second], original_scores, local_scores, options.metric);
+        }
+        std::swap(open_tracks, next_open_tracks);
+        std::swap(open_keys, next_open_keys);
+        next_open_tracks.clear();
+        next_open_keys.clear();
     }
 
-    local_scores = local_scores.to(scores.device());
+    local_scores = local_scores.to(scores.device(), scores.scalar_type());
     return local_scores;
 }
+
+static std::string get_stop_reason_string(const StopReason& stop_reason) {
+    /*
+    Converts @stop_reason to the name of the argument of seq_nms_bounded which caused it, or "completed".
+    */
+
+    switch (stop_reason) {
+        case StopReason::max_sequences:
+            return "max_sequences";
+        case StopReason::min_sequence_score:
+            return "min_sequence_score";
+        case StopReason::deadline:
+            return "deadline";
+        default:
+            return "completed";
+    }
+}
+
+std::tuple<torch::Tensor, std::string> seq_nms_bounded(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    const c10::optional<int64_t>& max_sequences,
+    const c10::optional<double>& min_sequence_score,
+    const c10::optional<double>& deadline_ms) {
+    /*
+    Same as seq_nms, but stops taking sequences once one of the limits is reached, so the latency of a dense clip can be
+    bounded. The boxes of the sequences taken until then keep their rescored scores, the other boxes keep theirs.
+
+    max_sequences is the number of sequences which are taken, per class if @class_aware is set.
+    min_sequence_score is the lowest cumulative score, i.e. the sum of the box scores, of a sequence which is taken.
+    deadline_ms is the time after the start of the call after which no sequence is taken. Building the graph is not
+        interrupted and the deadline is checked before each sequence, so the call can take longer by the time of
+        building the graph and of one sequence.
+
+    Returns the updated scores and why seq-nms stopped: "completed" if no limit was reached, otherwise "max_sequences",
+        "min_sequence_score" or "deadline". For a class aware call the reason is the one of the first class which
+        stopped early.
+    */
+
+    auto start = std::chrono::steady_clock::now();
+    seq_nms_options_t options = to_seq_nms_options(
+        linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
+    if (max_sequences.has_value() && (*max_sequences < 0)) {
+        throw std::invalid_argument("max_sequences is expected to be >= 0");
+    }
+    if (deadline_ms.has_value() && !(*deadline_ms >= 0.0)) {
+        throw std::invalid_argument("deadline_ms is expected to be >= 0");
+    }
+    options.limits.max_sequences = max_sequences;
+    options.limits.min_sequence_score = min_sequence_score;
+    if (deadline_ms.has_value()) {
+        auto budget = std::chrono::duration<double, std::milli>(*deadline_ms);
+        options.limits.deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget);
+    }
+
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+    // the scores are rescored in float32 whatever their type, the copy is needed anyway since they are updated in place
+    torch::Tensor local_scores = scores.to(torch::kCPU, torch::kFloat32, /*non_blocking=*/false, /*copy=*/true);
+
+    seq_nms_buffers_t buffers;
+    rescore_clip(boxes_cpu, local_scores, classes_cpu, options, buffers, nullptr);
+
+    local_scores = local_scores.to(scores.device(), scores.scalar_type());
+    return std::make_tuple(local_scores, get_stop_reason_string(buffers.stop_reason));
+}
+
+static void restore_graphs(seq_nms_buffers_t& buffers) {
+    // undoes the suppression of extract_linked_boxes, in the graphs of the subsets too
+    buffers.box_graph.restore_boxes();
+    for (seq_nms_buffers_t& subset : buffers.subsets) {
+        restore_graphs(subset);
+    }
+}
+
+torch::Tensor seq_nms_sweep(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const std::vector<double>& iou_thresholds,
+    const std::vector<std::string>& metrics,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame) {
+    /*
+    Applies seq_nms once for every configuration (@iou_thresholds[c], @metrics[c]) of the same clip, e.g. to tune them.
+    Returns the updated scores of the configurations stacked to the shape [C, F, N], with the type and device of
+    @scores.
+
+    The graph only depends on the boxes, the classes, the linkage threshold and the selected candidates, so the boxes are
+    converted and linked once. The configurations are then rescored in parallel. The converted boxes and classes are
+    only read and shared by all threads, every thread copies the linked graphs once and restores their boxes before each
+    configuration it takes, see BoxGraph::restore_boxes. A graph owns its edges, so they are copied with its alive mask
+    although only the mask is written. The threads take runs of configurations sorted by iou threshold, so consecutive
+    configurations of a thread with the same threshold share the frames of the overlap index built so far, see
+    overlap_index_t.
+    */
+
+    if (iou_thresholds.size() != metrics.size()) {
+        throw std::invalid_argument("iou_thresholds and metrics are expected to have the same length");
+    }
+    int num_configs = iou_thresholds.size();
+
+    std::vector<seq_nms_options_t> config_options;
+    for (int c_idx = 0; c_idx < num_configs; c_idx++) {
+        config_options.push_back(to_seq_nms_options(
+            linkage_threshold,
+            iou_thresholds[c_idx],
+            metrics[c_idx],
+            class_aware,
+            disjoint_sequences,
+            score_threshold,
+            max_boxes_per_frame));
+    }
+
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+    const auto scores_cpu = scores.to(torch::kCPU, torch::kFloat32);
+    torch::Tensor sweep_scores = scores_cpu.unsqueeze(0).repeat({num_configs, 1, 1});
+    if (num_configs == 0) {
+        return sweep_scores.to(scores.device(), scores.scalar_type());
+    }
+
+    // the configurations only differ in what link_boxes doesn't depend on, the boxes and classes are kept out of the
+    // linked buffers so the threads don't copy them
+    boxes_soa_t boxes_soa;
+    std::vector<int> box_classes;
+    to_boxes_soa(boxes_cpu, boxes_soa);
+    flatten_classes(boxes_soa, classes_cpu, box_classes);
+    seq_nms_buffers_t linked;
+    link_boxes(boxes_soa, box_classes, scores_cpu, config_options[0], linked, nullptr);
+
+    std::vector<int> config_order(num_configs);
+    std::iota(config_order.begin(), config_order.end(), 0);
+    std::stable_sort(config_order.begin(), config_order.end(), [&](const int& a, const int& b) {
+        return iou_thresholds[a] < iou_thresholds[b];
+    });
+
+    // every configuration only writes its own scores and the buffers of its thread, every thread takes one run
+    std::vector<torch::Tensor> config_scores = sweep_scores.unbind(0);
+    int64_t grain_size = (num_configs + at::get_num_threads() - 1) / at::get_num_threads();
+    at::parallel_for(0, num_configs, grain_size, [&](int64_t begin, int64_t end) {
+        // link_boxes doesn't gather the scores of the subsets, so the copy shares no tensor with the linked buffers
+        seq_nms_buffers_t buffers = linked;
+
+        for (int i = begin; i < end; i++) {
+            int c_idx = config_order[i];
+            restore_graphs(buffers);
+            extract_linked_boxes(boxes_soa, config_scores[c_idx], config_options[c_idx], buffers, nullptr);
+        }
+    });
+
+    return sweep_scores.to(scores.device(), scores.scalar_type());
+}
+
+static c10::ThreadPool& get_async_pool() {
+    /*
+    Returns the pool running seq_nms_async. It is separate from the inter-op pool, so clips aren't queued behind
+    torch.jit.fork tasks, and is created on first use with as many threads as the inter-op pool.
+    */
+
+    static c10::ThreadPool async_pool(at::get_num_interop_threads(), -1, []() { at::init_num_threads(); });
+    return async_pool;
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> seq_nms_async(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame) {
+    /*
+    Same as seq_nms, but returns a future of the updated scores right away and rescores the clip on a pool of its own,
+    see get_async_pool, so the caller can go on with e.g. the inference of the next clip. The clip still uses the
+    intra-op threads for its own parallel work.
+
+    Errors in the arguments are thrown by the call, errors while rescoring are set on the future. The boxes and classes
+    are read while the clip is rescored, so they are expected to be left unchanged until the future is completed.
+    */
+
+    seq_nms_options_t options = to_seq_nms_options(
+        linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
+
+    // the inputs are copied to the CPU by the caller, so the copies of CUDA tensors are ordered on its streams
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+    torch::Tensor local_scores = scores.to(torch::kCPU, torch::kFloat32, /*non_blocking=*/false, /*copy=*/true);
+
+    auto device = scores.device();
+    auto scalar_type = scores.scalar_type();
+    // a future only takes tensors on the devices it was created with, so it can synchronize their streams with the waiter
+    std::vector<c10::Device> future_devices;
+    if (!device.is_cpu()) {
+        future_devices.push_back(device);
+    }
+    auto future = c10::make_intrusive<c10::ivalue::Future>(c10::TensorType::get(), future_devices);
+    // e.g. the profiler and the grad mode of the caller also apply to the task
+    at::ThreadLocalState thread_locals;
+    get_async_pool().run([=]() mutable {
+        at::ThreadLocalStateGuard thread_locals_guard(thread_locals);
+        try {
+            rescore_clip(boxes_cpu, local_scores, classes_cpu, options, nullptr);
+            future->markCompleted(local_scores.to(device, scalar_type));
+        } catch (...) {
+            future->setError(std::current_exception());
+        }
+    });
+    return future;
+}
+
+std::tuple<torch::Tensor, c10::Dict<std::string, int64_t>> seq_nms_with_stats(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame) {
+    /*
+    Same as seq_nms, but also returns the counters of the call, see seq_nms_stats_t.
+    */
+
+    seq_nms_options_t options = to_seq_nms_options(
+        linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
+
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+    // the scores are rescored in float32 whatever their type, the copy is needed anyway since they are updated in place
+    torch::Tensor local_scores = scores.to(torch::kCPU, torch::kFloat32, /*non_blocking=*/false, /*copy=*/true);
+
+    seq_nms_stats_t stats;
+    rescore_clip(boxes_cpu, local_scores, classes_cpu, options, &stats);
+
+    c10::Dict<std::string, int64_t> stats_dict;
+    stats_dict.insert("iterations", stats.iterations);
+    stats_dict.insert("edges_built", stats.edges_built);
+    stats_dict.insert("edges_deleted", stats.edges_deleted);
+    stats_dict.insert("nodes_visited", stats.nodes_visited);
+    stats_dict.insert("build_ns", stats.build_ns);
+    stats_dict.insert("dp_ns", stats.dp_ns);
+    stats_dict.insert("rescore_ns", stats.rescore_ns);
+    stats_dict.insert("delete_ns", stats.delete_ns);
+    stats_dict.insert("peak_graph_bytes", stats.peak_graph_bytes);
+    stats_dict.insert("overlap_index_bytes", stats.overlap_index_bytes);
+    stats_dict.insert("buffer_growths", stats.buffer_growths);
+
+    local_scores = local_scores.to(scores.device(), scores.scalar_type());
+    return std::make_tuple(local_scores, stats_dict);
+}
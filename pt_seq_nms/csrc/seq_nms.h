@@ -1,14 +1,187 @@
 #pragma once
 #include <torch/torch.h>
+#include <chrono>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "box_graph.h"
+#include "box_utils.h"
 #include "custom_types.h"
 
-box_seq_t build_box_sequences(
+struct seq_nms_limits_t {
+    /*
+    Optional criteria for stopping the extraction of sequences before no sequence longer than one box is left, see
+    extract_sequences. The sequences taken until then keep their rescored scores, the other boxes keep theirs.
+    */
+
+    // the number of sequences taken, per class of a class aware clip
+    c10::optional<int64_t> max_sequences;
+    // the lowest cumulative score, i.e. sum of box scores, of a sequence which is taken
+    c10::optional<double> min_sequence_score;
+    // no sequence is taken after this point in time, building the graph is not interrupted
+    c10::optional<std::chrono::steady_clock::time_point> deadline;
+};
+
+struct seq_nms_options_t {
+    /*
+    The parameters of the seq-nms algorithm shared by the seq_nms ops, see seq_nms.
+    */
+
+    // as passed to the op, it is only rounded to float when linking, see get_linkage_threshold
+    double linkage_threshold;
+    float iou_threshold;
+    ScoreMetric metric;
+    bool class_aware;
+    bool disjoint_sequences;
+    c10::optional<double> score_threshold;
+    c10::optional<int64_t> max_boxes_per_frame;
+    seq_nms_limits_t limits;
+};
+
+struct seq_nms_stats_t {
+    /*
+    Counters of one seq_nms call, see seq_nms_with_stats. They are only collected if a seq_nms_stats_t is passed.
+
+    The phase times are summed over threads, e.g. the classes of a class aware call.
+    */
+
+    // number of sequences which were rescored
+    int64_t iterations = 0;
+    int64_t edges_built = 0;
+    int64_t edges_deleted = 0;
+    // number of boxes whose best path was recomputed
+    int64_t nodes_visited = 0;
+    int64_t build_ns = 0;
+    int64_t dp_ns = 0;
+    int64_t rescore_ns = 0;
+    int64_t delete_ns = 0;
+    // bytes allocated by the box graph, summed over the graphs of the classes if they are processed in parallel
+    int64_t peak_graph_bytes = 0;
+    // bytes allocated by the boxes overlapping each box, see overlap_index_t, summed the same way
+    int64_t overlap_index_bytes = 0;
+    // number of times a buffer of the extraction loop had to grow after the first solve, see BufferGrowthCounter, so 0
+    // once the buffers are as large as the clip needs
+    int64_t buffer_growths = 0;
+};
+
+struct frame_link_buffers_t {
+    /*
+    The buffers of link_frames, the edges of one frame in CSR layout and the boxes overlapping one box.
+    */
+
+    std::vector<int> offsets;
+    std::vector<int> edges;
+    std::vector<int> overlapping;
+};
+
+struct seq_nms_buffers_t {
+    /*
+    The memory used to rescore one clip, see rescore_clip. Vectors are cleared but never shrunk, so rescoring a clip
+    which is no larger than the ones before it with the same buffers doesn't allocate, see SeqNmsWorkspace.
+    */
+
+    // the clip in structure-of-arrays layout and the class of every box, in the same order
+    boxes_soa_t boxes;
+    std::vector<int> box_classes;
+    // the float32 scores [F, M] of a subset of a clip, see gather_scores, or of a packed clip, see rescore_packed_clip
+    torch::Tensor scores;
+
+    BoxGraph box_graph;
+    std::vector<int> frame_sizes;
+    // one per thread linking frames, indexed by at::get_thread_num()
+    std::vector<frame_link_buffers_t> link_buffers;
+
+    sequence_state_t sequence_state;
+    std::vector<int> sequence;
+    // the boxes overlapping each box, see overlap_index_t, or a buffer for the boxes overlapping one box if there is no
+    // index. The index is kept between extractions from the same graph at the same iou_threshold
+    overlap_index_t overlaps;
+    std::vector<int> overlapping;
+    // the boxes taken in a pass and the sequence starts, see extract_disjoint_sequences
+    std::vector<uint8_t> taken;
+    std::vector<int> taken_nodes;
+    std::vector<std::tuple<float, int, int>> candidates;
+
+    // the sequences taken, in the order they were taken, sequence s has the boxes
+    // sequence_boxes[sequence_offsets[s]:sequence_offsets[s + 1]] (indices into boxes) and was rescored to
+    // sequence_scores[s]
+    std::vector<int> sequence_offsets;
+    std::vector<int> sequence_boxes;
+    std::vector<float> sequence_scores;
+    // why the extraction stopped, for a class aware clip the reason of the first class which stopped early
+    StopReason stop_reason = StopReason::completed;
+
+    // the boxes of the subset this clip was copied from, see select_boxes
+    std::vector<int> frame_offsets;
+    std::vector<int> box_indices;
+    // sorted ids of the classes of a class aware clip
+    std::vector<int> class_ids;
+    // the buffers of the selected candidates or of each class of the clip
+    std::vector<seq_nms_buffers_t> subsets;
+};
+
+void link_frames(
+    const boxes_soa_t& boxes,
+    const std::vector<int>& classes,
+    const int& frame_idx,
+    const float& linkage_threshold,
+    std::vector<int>& offsets,
+    std::vector<int>& edges,
+    std::vector<int>& overlapping);
+
+BoxGraph build_box_sequences(const boxes_soa_t& boxes, const torch::Tensor& classes, const double& linkage_threshold);
+
+ScoreMetric get_score_enum_from_string(const std::string& metric_string);
+
+void extract_sequences(
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    torch::Tensor& scores,
+    const float& iou_threshold,
+    const ScoreMetric& metric,
+    const bool& disjoint_sequences,
+    seq_nms_stats_t* stats);
+
+void extract_sequences(
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    torch::Tensor& scores,
+    const sequence_state_t& sequence_state,
+    const float& iou_threshold,
+    const ScoreMetric& metric,
+    seq_nms_buffers_t& buffers);
+
+void rescore_clip(
     const torch::Tensor& boxes,
-    const torch::Tensor& box_areas,
+    torch::Tensor& scores,
     const torch::Tensor& classes,
-    const double& linkage_threshold);
+    const seq_nms_options_t& options,
+    seq_nms_stats_t* stats);
 
-ScoreMetric get_score_enum_from_string(const std::string& metric_string);
+void rescore_clip(
+    const torch::Tensor& boxes,
+    torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const seq_nms_options_t& options,
+    seq_nms_buffers_t& buffers,
+    seq_nms_stats_t* stats);
+
+void rescore_packed_clip(
+    const torch::Tensor& boxes,
+    torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const std::vector<int>& frame_offsets,
+    const seq_nms_options_t& options,
+    seq_nms_buffers_t& buffers);
+
+seq_nms_options_t to_seq_nms_options(
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame);
 
 torch::Tensor seq_nms(
     const torch::Tensor& boxes,
@@ -16,4 +189,123 @@ torch::Tensor seq_nms(
     const torch::Tensor& classes,
     const double& linkage_threshold,
     const double& iou_threshold,
-    const std::string& metric);
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame);
+
+torch::Tensor& seq_nms_out(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    torch::Tensor& out);
+
+torch::Tensor seq_nms_batched(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame);
+
+torch::Tensor seq_nms_packed(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const torch::Tensor& frame_offsets,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame);
+
+std::tuple<torch::Tensor, torch::Tensor, torch::Tensor, torch::Tensor> seq_nms_with_sequences(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame);
+
+torch::Tensor seq_nms_chunked(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    const int64_t& chunk_size,
+    const int64_t& chunk_overlap);
+
+std::tuple<torch::Tensor, std::string> seq_nms_bounded(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    const c10::optional<int64_t>& max_sequences,
+    const c10::optional<double>& min_sequence_score,
+    const c10::optional<double>& deadline_ms);
+
+torch::Tensor seq_nms_sweep(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const std::vector<double>& iou_thresholds,
+    const std::vector<std::string>& metrics,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame);
+
+c10::intrusive_ptr<c10::ivalue::Future> seq_nms_async(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame);
+
+std::tuple<torch::Tensor, c10::Dict<std::string, int64_t>> seq_nms_with_stats(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame);
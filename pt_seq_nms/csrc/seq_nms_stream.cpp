@@ -0,0 +1,174 @@
+#include "seq_nms_stream.h"
+#include <ATen/Dispatch.h>
+#include <algorithm>
+#include <stdexcept>
+#include "sequence_utils.h"
+
+SeqNmsStream::SeqNmsStream(
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const int64_t& lookahead)
+    : linkage_threshold_(static_cast<float>(linkage_threshold)),
+      iou_threshold_(static_cast<float>(iou_threshold)),
+      metric_(get_score_enum_from_string(metric)),
+      lookahead_(lookahead) {
+    if (lookahead < 0) {
+        throw std::invalid_argument("lookahead should be >= 0");
+    }
+
+    boxes_.frame_offsets.assign(1, 0);
+    boxes_.sorted_offsets.assign(1, 0);
+    prepare_overlap_index(boxes_, iou_threshold_, buffers_.overlaps);
+}
+
+std::vector<torch::Tensor> SeqNmsStream::push_frame(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes) {
+    /*
+    Adds the next frame of the stream.
+
+    boxes are expected to have the shape [N, 4] and of the format [x_min, y_min, x_max, y_max].
+        N is the number of objects in the frame, it can vary between frames.
+    scores are expected to have the shape [N].
+    classes are expected to have the shape [N].
+    The supported types are the same as for seq_nms.
+
+    Returns the updated scores of the frame that got finalized by this frame, or nothing if no frame got finalized.
+    */
+
+    if ((boxes.dim() != 2) || (boxes.size(1) != 4) || (scores.dim() != 1) || (classes.dim() != 1) ||
+        (scores.size(0) != boxes.size(0)) || (classes.size(0) != boxes.size(0))) {
+        throw std::invalid_argument("Expected boxes with the shape [N, 4], and scores and classes with the shape [N]");
+    }
+
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto scores_cpu = scores.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+
+    append_frame(boxes_, boxes_cpu);
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::kHalf, at::kBFloat16, scores_cpu.scalar_type(), "push_frame", [&] {
+        auto scores_acc = scores_cpu.accessor<scalar_t, 1>();
+        for (int b_idx = 0; b_idx < boxes_cpu.size(0); b_idx++) {
+            scores_.push_back(static_cast<float>(scores_acc[b_idx]));
+        }
+    });
+    AT_DISPATCH_INDEX_TYPES(classes_cpu.scalar_type(), "push_frame", [&] {
+        auto classes_acc = classes_cpu.accessor<index_t, 1>();
+        for (int b_idx = 0; b_idx < boxes_cpu.size(0); b_idx++) {
+            classes_.push_back(static_cast<int>(classes_acc[b_idx]));
+        }
+    });
+    devices_.push_back(scores.device());
+    score_types_.push_back(scores.scalar_type());
+
+    // only the link from the previous frame to the new frame is missing
+    int num_frames = num_pending_frames();
+    box_graph_.append_frame(boxes_cpu.size(0));
+    append_frame(box_graph_, sequence_state_);
+    append_frame(buffers_.overlaps);
+    if (num_frames > 1) {
+        link_frames(
+            boxes_,
+            classes_,
+            num_frames - 2,
+            linkage_threshold_,
+            link_buffers_.offsets,
+            link_buffers_.edges,
+            link_buffers_.overlapping);
+        box_graph_.set_frame_links(num_frames - 2, link_buffers_.offsets, link_buffers_.edges);
+    }
+
+    std::vector<torch::Tensor> finalized_scores;
+    if (num_frames > lookahead_) {
+        torch::Tensor rescored = rescore_pending_frames();
+        finalized_scores.push_back(pop_frame(rescored[0]));
+    }
+    return finalized_scores;
+}
+
+std::vector<torch::Tensor> SeqNmsStream::flush() {
+    /*
+    Finalizes all pending frames, e.g. at the end of the stream, and returns their updated scores from oldest to newest.
+    The stream can be used for a new clip afterwards.
+    */
+
+    std::vector<torch::Tensor> finalized_scores;
+    if (num_pending_frames() == 0) {
+        return finalized_scores;
+    }
+
+    torch::Tensor rescored = rescore_pending_frames();
+    for (int f_idx = 0; f_idx < rescored.size(0); f_idx++) {
+        finalized_scores.push_back(pop_frame(rescored[f_idx]));
+    }
+    return finalized_scores;
+}
+
+int64_t SeqNmsStream::num_pending_frames() const {
+    return boxes_.frame_offsets.size() - 1;
+}
+
+torch::Tensor SeqNmsStream::rescore_pending_frames() {
+    /*
+    Applies seq-nms to the pending frames, starting from their original scores.
+
+    The best paths of the original scores are brought up to date first, only the frames pushed since the last rescoring
+    and the frame before them are dirty, see update_sequence_state. The extraction then starts from a copy of them.
+
+    The returned scores have the shape [F, M], where M is the largest number of boxes in a pending frame.
+    */
+
+    int num_frames = num_pending_frames();
+    int max_boxes = 0;
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        max_boxes = std::max(max_boxes, box_graph_.num_boxes(f_idx));
+    }
+
+    torch::Tensor scores = torch::zeros({num_frames, max_boxes}, torch::kFloat32);
+    auto scores_acc = scores.accessor<float, 2>();
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        for (int b_idx = 0; b_idx < box_graph_.num_boxes(f_idx); b_idx++) {
+            scores_acc[f_idx][b_idx] = scores_[boxes_.frame_offsets[f_idx] + b_idx];
+        }
+    }
+
+    // undoes the suppression of the previous rescoring
+    box_graph_.restore_boxes();
+    if (first_unsolved_frame_ < num_frames) {
+        update_sequence_state(box_graph_, scores, sequence_state_, std::max(first_unsolved_frame_ - 1, 0), num_frames - 1);
+        first_unsolved_frame_ = num_frames;
+    }
+
+    extract_sequences(boxes_, box_graph_, scores, sequence_state_, iou_threshold_, metric_, buffers_);
+    return scores;
+}
+
+torch::Tensor SeqNmsStream::pop_frame(const torch::Tensor& rescored) {
+    /*
+    Removes the oldest pending frame and returns its scores, @rescored are the scores of the frame padded to any length.
+    */
+
+    int num_boxes = boxes_.frame_offsets[1];
+    auto rescored_acc = rescored.accessor<float, 1>();
+
+    torch::Tensor frame_scores = torch::empty({num_boxes}, torch::kFloat32);
+    auto frame_scores_acc = frame_scores.accessor<float, 1>();
+    for (int b_idx = 0; b_idx < num_boxes; b_idx++) {
+        frame_scores_acc[b_idx] = rescored_acc[b_idx];
+    }
+    frame_scores = frame_scores.to(devices_.front(), score_types_.front());
+
+    remove_first_frame(boxes_);
+    classes_.erase(classes_.begin(), classes_.begin() + num_boxes);
+    scores_.erase(scores_.begin(), scores_.begin() + num_boxes);
+    devices_.pop_front();
+    score_types_.pop_front();
+    box_graph_.remove_first_frame();
+    remove_first_frame(box_graph_, sequence_state_);
+    remove_first_frame(buffers_.overlaps);
+    first_unsolved_frame_ = std::max(first_unsolved_frame_ - 1, 0);
+
+    return frame_scores;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <torch/torch.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "box_graph.h"
+#include "box_utils.h"
+#include "custom_types.h"
+#include "seq_nms.h"
+
+class SeqNmsStream : public torch::CustomClassHolder {
+    /*
+    Applies the seq-nms algorithm to a stream of frames, e.g. a live video.
+
+    A frame is finalized once @lookahead newer frames have been pushed, seq-nms is then applied to the pending frames
+    and the scores of the oldest one are returned. Finalized frames are dropped, so the work per frame only depends on
+    @lookahead. If no frame is finalized before flush, the scores are the same as seq_nms on the whole clip.
+
+    The graph, the best paths for the original scores and the overlap index of the pending frames are kept between
+    pushes. A push only links the new frame, and only the frames pushed since the last rescoring are solved again,
+    the best paths run backwards, so dropping the oldest frame doesn't change the others. The sequences themselves are
+    extracted again from a copy of the best paths every time a frame is finalized, since a new frame can change which
+    sequences are taken.
+    */
+
+  public:
+    SeqNmsStream(
+        const double& linkage_threshold,
+        const double& iou_threshold,
+        const std::string& metric,
+        const int64_t& lookahead);
+
+    std::vector<torch::Tensor> push_frame(
+        const torch::Tensor& boxes,
+        const torch::Tensor& scores,
+        const torch::Tensor& classes);
+
+    std::vector<torch::Tensor> flush();
+
+    int64_t num_pending_frames() const;
+
+  private:
+    torch::Tensor rescore_pending_frames();
+
+    torch::Tensor pop_frame(const torch::Tensor& rescored);
+
+    float linkage_threshold_;
+    float iou_threshold_;
+    ScoreMetric metric_;
+    int64_t lookahead_;
+
+    // the pending frames, box b of frame f is at index boxes_.frame_offsets[f] + b in all of them
+    boxes_soa_t boxes_;
+    std::vector<int> classes_;
+    std::vector<float> scores_;
+    // the device and type of the scores of each pending frame, its returned scores are converted back to them
+    std::deque<torch::Device> devices_;
+    std::deque<torch::ScalarType> score_types_;
+
+    // the graph of the pending frames and its best paths for the original scores, solved up to first_unsolved_frame_,
+    // see rescore_pending_frames
+    BoxGraph box_graph_;
+    sequence_state_t sequence_state_;
+    int first_unsolved_frame_ = 0;
+    // the working memory of the extraction, its overlap index follows the pending frames
+    seq_nms_buffers_t buffers_;
+    frame_link_buffers_t link_buffers_;
+};
@@ -0,0 +1,137 @@
+#include "seq_nms_workspace.h"
+#include <vector>
+
+template <typename T>
+static int64_t vector_bytes(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+static int64_t boxes_bytes(const boxes_soa_t& boxes) {
+    int64_t bytes = vector_bytes(boxes.x1) + vector_bytes(boxes.y1) + vector_bytes(boxes.x2) + vector_bytes(boxes.y2);
+    bytes += vector_bytes(boxes.areas) + vector_bytes(boxes.frame_offsets) + vector_bytes(boxes.indexed_frames);
+    bytes += vector_bytes(boxes.sorted_offsets) + vector_bytes(boxes.sorted_boxes) + vector_bytes(boxes.sorted_x1);
+    bytes += vector_bytes(boxes.sorted_y1) + vector_bytes(boxes.sorted_x2) + vector_bytes(boxes.sorted_y2);
+    bytes += vector_bytes(boxes.sorted_areas) + vector_bytes(boxes.sorted_max_x2);
+    return bytes;
+}
+
+static int64_t overlap_index_reserved_bytes(const overlap_index_t& index) {
+    // unlike overlap_index_bytes, the frames which aren't built also hold memory
+    int64_t bytes = vector_bytes(index.frames) + vector_bytes(index.built);
+    for (const frame_overlaps_t& frame_overlaps : index.frames) {
+        bytes += vector_bytes(frame_overlaps.offsets) + vector_bytes(frame_overlaps.boxes);
+    }
+    return bytes;
+}
+
+static int64_t buffers_bytes(const seq_nms_buffers_t& buffers) {
+    /*
+    Returns the number of bytes allocated by @buffers on the heap, including its subsets.
+    */
+
+    int64_t bytes = boxes_bytes(buffers.boxes) + vector_bytes(buffers.box_classes);
+    bytes += buffers.scores.defined() ? buffers.scores.storage().nbytes() : 0;
+    bytes += buffers.box_graph.num_bytes() - sizeof(BoxGraph);
+    bytes += vector_bytes(buffers.frame_sizes) + vector_bytes(buffers.link_buffers);
+    for (const frame_link_buffers_t& link_buffers : buffers.link_buffers) {
+        bytes += vector_bytes(link_buffers.offsets) + vector_bytes(link_buffers.edges);
+        bytes += vector_bytes(link_buffers.overlapping);
+    }
+
+    const sequence_state_t& state = buffers.sequence_state;
+    bytes += vector_bytes(state.path_scores) + vector_bytes(state.predecessors) + vector_bytes(state.has_incoming);
+    bytes += vector_bytes(state.frame_best_roots) + vector_bytes(state.task_incoming);
+    bytes += vector_bytes(buffers.sequence) + overlap_index_reserved_bytes(buffers.overlaps) + vector_bytes(buffers.taken);
+    bytes += vector_bytes(buffers.overlapping) + vector_bytes(buffers.taken_nodes) + vector_bytes(buffers.candidates);
+    bytes += vector_bytes(buffers.sequence_offsets) + vector_bytes(buffers.sequence_boxes);
+    bytes += vector_bytes(buffers.sequence_scores);
+    bytes += vector_bytes(buffers.frame_offsets) + vector_bytes(buffers.box_indices) + vector_bytes(buffers.class_ids);
+
+    bytes += vector_bytes(buffers.subsets);
+    for (const seq_nms_buffers_t& subset : buffers.subsets) {
+        bytes += buffers_bytes(subset);
+    }
+    return bytes;
+}
+
+void SeqNmsWorkspace::rescore_(
+    const torch::Tensor& boxes,
+    const torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const seq_nms_options_t& options) {
+    /*
+    Applies the seq-nms algorithm to one clip and writes the updated scores to @scores, see seq_nms_.
+
+    Float32 CPU scores are rescored where they are, other scores through a float32 copy kept in the workspace.
+    */
+
+    const auto boxes_cpu = boxes.to(torch::kCPU);
+    const auto classes_cpu = classes.to(torch::kCPU);
+    // a new handle to the same data, writing to it updates @scores
+    torch::Tensor updated_scores = scores;
+
+    if (scores.device().is_cpu() && (scores.scalar_type() == torch::kFloat32)) {
+        rescore_clip(boxes_cpu, updated_scores, classes_cpu, options, buffers_, nullptr);
+        return;
+    }
+
+    if (scores_.defined()) {
+        scores_.resize_(scores.sizes());
+    } else {
+        scores_ = torch::empty(scores.sizes(), torch::kFloat32);
+    }
+    scores_.copy_(scores);
+    rescore_clip(boxes_cpu, scores_, classes_cpu, options, buffers_, nullptr);
+    updated_scores.copy_(scores_);
+}
+
+int64_t SeqNmsWorkspace::num_bytes() const {
+    /*
+    Returns the number of bytes held by the workspace, i.e. the high-water mark of the calls since it was created or
+    cleared.
+    */
+
+    int64_t bytes = buffers_bytes(buffers_);
+    bytes += scores_.defined() ? scores_.storage().nbytes() : 0;
+    return bytes;
+}
+
+void SeqNmsWorkspace::clear() {
+    /*
+    Frees the memory held by the workspace, e.g. after an unusually large clip.
+    */
+
+    buffers_ = seq_nms_buffers_t();
+    scores_ = torch::Tensor();
+}
+
+torch::Tensor& seq_nms_(
+    const torch::Tensor& boxes,
+    torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    const c10::optional<c10::intrusive_ptr<SeqNmsWorkspace>>& workspace) {
+    /*
+    Same as seq_nms, but writes the updated scores to @scores instead of a new tensor and returns @scores.
+
+    workspace is the working memory of the call, if set. Passing the same workspace to every call of e.g. a serving
+    loop reuses its memory, see SeqNmsWorkspace. Otherwise a workspace is created for the call.
+    */
+
+    seq_nms_options_t options = to_seq_nms_options(
+        linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
+
+    if (workspace.has_value()) {
+        (*workspace)->rescore_(boxes, scores, classes, options);
+    } else {
+        SeqNmsWorkspace local_workspace;
+        local_workspace.rescore_(boxes, scores, classes, options);
+    }
+    return scores;
+}
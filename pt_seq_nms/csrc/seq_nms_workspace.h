@@ -0,0 +1,45 @@
+#pragma once
+#include <torch/torch.h>
+#include <string>
+#include "seq_nms.h"
+
+class SeqNmsWorkspace : public torch::CustomClassHolder {
+    /*
+    The working memory of seq_nms_, kept between calls.
+
+    The box copies, the graph, the best paths and the per class copies of a call are kept in the workspace and grow to
+    the largest clip seen, so once a workspace has seen a clip at least as large as the next one, rescoring it doesn't
+    allocate. A workspace must not be used by two calls at the same time.
+    */
+
+  public:
+    SeqNmsWorkspace() {}
+
+    void rescore_(
+        const torch::Tensor& boxes,
+        const torch::Tensor& scores,
+        const torch::Tensor& classes,
+        const seq_nms_options_t& options);
+
+    int64_t num_bytes() const;
+
+    void clear();
+
+  private:
+    seq_nms_buffers_t buffers_;
+    // float32 copy of scores which can't be rescored in place, e.g. float16 or CUDA scores
+    torch::Tensor scores_;
+};
+
+torch::Tensor& seq_nms_(
+    const torch::Tensor& boxes,
+    torch::Tensor& scores,
+    const torch::Tensor& classes,
+    const double& linkage_threshold,
+    const double& iou_threshold,
+    const std::string& metric,
+    const bool& class_aware,
+    const bool& disjoint_sequences,
+    const c10::optional<double>& score_threshold,
+    const c10::optional<int64_t>& max_boxes_per_frame,
+    const c10::optional<c10::intrusive_ptr<SeqNmsWorkspace>>& workspace);
@@ -1,153 +1,336 @@
 #include "sequence_utils.h"
+#include <ATen/Parallel.h>
 #include <algorithm>
 #include "box_utils.h"
 
-using namespace torch::indexing;
+// a frame is relaxed in parallel in one task per thread, but never in tasks of fewer boxes than this, see update_frame
+const int FRAME_MIN_GRAIN_SIZE = 256;
 
-std::tuple<int, std::vector<int>, float> find_highest_score_sequence(const std::vector<score_indicies_list>& sequences) {
+std::tuple<int, int, float> find_highest_score_sequence(const std::vector<std::tuple<float, int>>& frame_best_roots) {
     /*
-    Find the element that has the highest score.
+    Find the sequence start that has the highest score.
 
-    sequences are expected to have a length of number of frames.
-        For each element in sequences are expected to have a length number of boxes.
+    frame_best_roots are expected to have a length of number of frames.
+        Each element is the (score, box index) of the best sequence start in that frame, box index is -1 if there is none.
+    Ties are resolved to the earliest frame. Returns (frame index, box index, score), box index is -1 if no sequence
+    has a score above zero.
     */
 
     float best_score = 0.0;
-    std::vector<int> best_sequence;
+    int best_box = -1;
     int sequence_frame_index = 0;
 
-    for (int f_idx = 0; f_idx < sequences.size(); f_idx++) {
-        score_indicies_list frame_sequences = sequences[f_idx];
+    for (int f_idx = 0; f_idx < frame_best_roots.size(); f_idx++) {
+        float root_score = std::get<0>(frame_best_roots[f_idx]);
+        int root_box = std::get<1>(frame_best_roots[f_idx]);
 
-        if (frame_sequences.size() == 0) {
-            continue;
+        if ((root_box >= 0) && (root_score > best_score)) {
+            best_score = root_score;
+            best_box = root_box;
+            sequence_frame_index = f_idx;
         }
+    }
+
+    return std::make_tuple(sequence_frame_index, best_box, best_score);
+}
 
-        auto score_tensor = torch::empty(frame_sequences.size(), {torch::kFloat32});
-        auto score_acc = score_tensor.accessor<float, 1>();
-        for (int i = 0; i < frame_sequences.size(); i++) {
-            score_acc[i] = std::get<0>(frame_sequences[i]);
+static bool update_frame(
+    const BoxGraph& box_graph,
+    const torch::Tensor& scores,
+    sequence_state_t& state,
+    const int& frame_idx) {
+    /*
+    Recomputes the best paths starting in frame @frame_idx from the best paths of frame @frame_idx + 1, and which boxes in
+    frame @frame_idx + 1 are linked from frame @frame_idx.
+
+    Every box only reads the next frame, so a frame is split into one task per thread which are relaxed in parallel,
+    unless the tasks would have fewer than FRAME_MIN_GRAIN_SIZE boxes. Each task marks the boxes it links to in its own
+    bitset and the bitsets are merged afterwards, so the result is the same as the sequential one and doesn't depend on
+    the threads.
+
+    Returns true if any of the best path scores in frame @frame_idx changed.
+    */
+
+    auto scores_acc = scores.accessor<float, 2>();
+    bool has_next_frame = frame_idx < box_graph.num_frames() - 1;
+    int num_boxes = box_graph.num_boxes(frame_idx);
+    int num_next_boxes = has_next_frame ? box_graph.num_boxes(frame_idx + 1) : 0;
+
+    float* path_scores = state.path_scores.data() + box_graph.frame_offset(frame_idx);
+    int* predecessors = state.predecessors.data() + box_graph.frame_offset(frame_idx);
+
+    const float* next_scores = nullptr;
+    uint8_t* next_has_incoming = nullptr;
+    if (has_next_frame) {
+        next_scores = state.path_scores.data() + box_graph.frame_offset(frame_idx + 1);
+        next_has_incoming = state.has_incoming.data() + box_graph.frame_offset(frame_idx + 1);
+        std::fill(next_has_incoming, next_has_incoming + num_next_boxes, 0);
+    }
+
+    // relaxes box @box_idx, calls @mark_incoming with every box it links to and returns true if its score changed
+    auto relax_box = [&](const int& box_idx, const auto& mark_incoming) {
+        float score = scores_acc[frame_idx][box_idx];
+        int predecessor = -1;
+
+        if (has_next_frame) {
+            // strict comparison keeps the first maximum, same as torch::argmax
+            box_graph.for_each_edge(frame_idx, box_idx, [&](const int& e_idx) {
+                mark_incoming(e_idx);
+                if ((predecessor < 0) || (next_scores[e_idx] > next_scores[predecessor])) {
+                    predecessor = e_idx;
+                }
+            });
+
+            if (predecessor >= 0) {
+                score = score + next_scores[predecessor];
+            }
         }
 
-        int max_idx = torch::argmax(score_tensor).item<int>();
+        bool changed = path_scores[box_idx] != score;
+        path_scores[box_idx] = score;
+        predecessors[box_idx] = predecessor;
+        return changed;
+    };
+
+    int num_threads = at::get_num_threads();
+    int grain_size = std::max((num_boxes + num_threads - 1) / num_threads, FRAME_MIN_GRAIN_SIZE);
+    int num_tasks = (num_boxes + grain_size - 1) / grain_size;
+    if ((num_tasks <= 1) || at::in_parallel_region()) {
+        auto mark_incoming = [&](const int& e_idx) { next_has_incoming[e_idx] = 1; };
+        bool changed = false;
+        for (int box_idx = 0; box_idx < num_boxes; box_idx++) {
+            changed = relax_box(box_idx, mark_incoming) || changed;
+        }
+        return changed;
+    }
 
-        if (std::get<0>(frame_sequences[max_idx]) > best_score) {
-            best_score = std::get<0>(frame_sequences[max_idx]);
+    int num_words = (num_next_boxes + 63) / 64;
+    state.task_incoming.assign(static_cast<size_t>(num_tasks) * num_words, 0);
+    std::vector<uint8_t> task_changed(num_tasks, 0);
 
-            best_sequence = std::get<1>(frame_sequences[max_idx]);
-            std::reverse(best_sequence.begin(), best_sequence.end());
+    at::parallel_for(0, num_tasks, 1, [&](int64_t begin, int64_t end) {
+        for (int t_idx = begin; t_idx < end; t_idx++) {
+            uint64_t* incoming = state.task_incoming.data() + static_cast<size_t>(t_idx) * num_words;
+            auto mark_incoming = [&](const int& e_idx) { incoming[e_idx / 64] |= uint64_t(1) << (e_idx % 64); };
+            int last_box = std::min((t_idx + 1) * grain_size, num_boxes);
 
-            sequence_frame_index = f_idx;
+            bool changed = false;
+            for (int box_idx = t_idx * grain_size; box_idx < last_box; box_idx++) {
+                changed = relax_box(box_idx, mark_incoming) || changed;
+            }
+            task_changed[t_idx] = changed;
         }
+    });
+
+    // merges the links of the tasks into the first bitset
+    for (int t_idx = 1; t_idx < num_tasks; t_idx++) {
+        const uint64_t* incoming = state.task_incoming.data() + static_cast<size_t>(t_idx) * num_words;
+        for (int w_idx = 0; w_idx < num_words; w_idx++) {
+            state.task_incoming[w_idx] |= incoming[w_idx];
+        }
+    }
+    for (int e_idx = 0; e_idx < num_next_boxes; e_idx++) {
+        next_has_incoming[e_idx] = (state.task_incoming[e_idx / 64] >> (e_idx % 64)) & 1;
     }
 
-    return std::make_tuple(sequence_frame_index, best_sequence, best_score);
+    return std::find(task_changed.begin(), task_changed.end(), 1) != task_changed.end();
 }
 
-std::tuple<int, std::vector<int>, float> find_best_sequence(const box_seq_t& box_graph, const torch::Tensor& scores) {
+static void update_frame_best_root(const BoxGraph& box_graph, sequence_state_t& state, const int& frame_idx) {
     /*
-    A function for finding the best path through the graph @box_graph.
-    The best path is the one that has the highest cumulative sum.
-    We dynamically build up best paths through graph starting from the end frame such that we can determine the beginning of
-    sequences. For example if there are no links to a box from previous frames, then it is a candidate for starting a sequence.
+    Finds the highest scoring box in frame @frame_idx which isn't linked from the previous frame.
+    Ties are resolved to the lowest box index, same as torch::argmax.
     */
 
-    std::vector<score_indicies_list> max_scores_paths;
-    std::vector<score_indicies_list> sequence_roots;
+    const float* path_scores = state.path_scores.data() + box_graph.frame_offset(frame_idx);
+    const uint8_t* has_incoming = state.has_incoming.data() + box_graph.frame_offset(frame_idx);
 
-    auto scores_acc = scores.accessor<float, 2>();
+    float best_score = 0.0;
+    int best_idx = -1;
+    for (int box_idx = 0; box_idx < box_graph.num_boxes(frame_idx); box_idx++) {
+        if (has_incoming[box_idx]) {
+            continue;
+        }
 
-    score_indicies_list last_scores;
-    for (int idx = 0; idx < scores.size(1); idx++) {
-        float score = scores_acc[scores.size(0) - 1][idx];
-        auto index_list = std::vector<int>{idx};
-        last_scores.push_back(std::make_tuple(score, index_list));
+        if ((best_idx < 0) || (path_scores[box_idx] > best_score)) {
+            best_score = path_scores[box_idx];
+            best_idx = box_idx;
+        }
     }
-    max_scores_paths.push_back(last_scores);
 
-    for (int frame_idx = box_graph.size() - 1; frame_idx >= 0; frame_idx--) {
-        auto frame_edges = box_graph[frame_idx];
+    state.frame_best_roots[frame_idx] = std::make_tuple(best_score, best_idx);
+}
+
+sequence_state_t init_sequence_state(const BoxGraph& box_graph, const torch::Tensor& scores) {
+    /*
+    Solves the best paths through @box_graph for all frames, see find_best_sequence.
+
+    scores are expected to have the shape [F, N].
+    */
 
-        auto used_in_sequence = torch::zeros(static_cast<long>(max_scores_paths.back().size()), {torch::kBool});
-        auto used_in_sequence_acc = used_in_sequence.accessor<bool, 1>();
+    sequence_state_t state;
+    init_sequence_state(box_graph, scores, state);
+    return state;
+}
 
-        score_indicies_list max_path_frame;
-        for (int box_idx = 0; box_idx < frame_edges.size(); box_idx++) {
-            std::vector<int> box_edges = frame_edges[box_idx];
+void init_sequence_state(const BoxGraph& box_graph, const torch::Tensor& scores, sequence_state_t& state) {
+    /*
+    Same as init_sequence_state(box_graph, scores), but overwrites @state and reuses its memory.
+    */
 
-            if (box_edges.size() == 0) {
-                // no edges for current box so consider it a max path consisting of a single node
-                float score = scores_acc[frame_idx][box_idx];
+    int num_frames = box_graph.num_frames();
+    int num_nodes = box_graph.num_nodes();
 
-                std::vector<int> indicies = {box_idx};
-                max_path_frame.push_back(std::make_tuple(score, indicies));
-            } else {
-                // extend previous max paths
-                // here we use box_edges to index used_in_sequence and mark boxes in corresponding frame t+1
-                // as part of a sequence since we have links to them and can always make a better max path by making it longer
-                // (score >= 0.0)
+    state.path_scores.assign(num_nodes, 0.0);
+    state.predecessors.assign(num_nodes, -1);
+    state.has_incoming.assign(num_nodes, 0);
+    state.frame_best_roots.assign(num_frames, std::make_tuple(0.0f, -1));
 
-                auto score_tensor = torch::empty(box_edges.size(), {torch::kFloat32});
-                auto score_acc = score_tensor.accessor<float, 1>();
+    update_sequence_state(box_graph, scores, state, 0, num_frames - 1);
+}
 
-                for (int i = 0; i < box_edges.size(); i++) {
-                    int e_idx = box_edges[i];
-                    used_in_sequence_acc[e_idx] = true;
-                    score_acc[i] = std::get<0>(max_scores_paths.back()[e_idx]);
-                }
+void append_frame(const BoxGraph& box_graph, sequence_state_t& state) {
+    /*
+    Extends @state by the frame just appended to @box_graph, see BoxGraph::append_frame. The best paths of the new frame
+    and of the frames linking to it are only solved by the next update_sequence_state with the new frame and the one
+    before it as dirty frames.
+    */
 
-                int prev_idx = torch::argmax(score_tensor).item<int>();
-                float score_so_far = std::get<0>(max_scores_paths.back()[box_edges[prev_idx]]);
-                std::vector<int> path_so_far = std::get<1>(max_scores_paths.back()[box_edges[prev_idx]]);
-                path_so_far.push_back(box_idx);
+    state.path_scores.resize(box_graph.num_nodes(), 0.0);
+    state.predecessors.resize(box_graph.num_nodes(), -1);
+    state.has_incoming.resize(box_graph.num_nodes(), 0);
+    state.frame_best_roots.emplace_back(0.0f, -1);
+}
 
-                max_path_frame.push_back(std::make_tuple(scores_acc[frame_idx][box_idx] + score_so_far, path_so_far));
-            }
-        }
+void remove_first_frame(const BoxGraph& box_graph, sequence_state_t& state) {
+    /*
+    Drops the first frame from @state after it was removed from @box_graph, see BoxGraph::remove_first_frame.
 
-        // create new sequence roots for boxes in frame at frame_idx + 1 that did not have links from boxes in frame_idx
-        score_indicies_list new_sequence_root;
-        for (int idx = 0; idx < used_in_sequence.size(0); idx++) {
-            if (!used_in_sequence_acc[idx]) {
-                new_sequence_root.push_back(max_scores_paths.back()[idx]);
-            }
-        }
+    The DP runs backwards, so the best paths of the other frames don't depend on the first frame and are kept. Only the
+    new first frame changes, it isn't linked from a previous frame anymore, so every one of its boxes can start a
+    sequence.
+    */
 
-        sequence_roots.push_back(new_sequence_root);
-        max_scores_paths.push_back(max_path_frame);
+    int num_removed = static_cast<int>(state.path_scores.size()) - box_graph.num_nodes();
+    state.path_scores.erase(state.path_scores.begin(), state.path_scores.begin() + num_removed);
+    state.predecessors.erase(state.predecessors.begin(), state.predecessors.begin() + num_removed);
+    state.has_incoming.erase(state.has_incoming.begin(), state.has_incoming.begin() + num_removed);
+    state.frame_best_roots.erase(state.frame_best_roots.begin());
+
+    if (box_graph.num_frames() > 0) {
+        std::fill(state.has_incoming.begin(), state.has_incoming.begin() + box_graph.num_boxes(0), 0);
+        update_frame_best_root(box_graph, state, 0);
     }
+}
 
-    sequence_roots.push_back(max_scores_paths.back());
+int64_t update_sequence_state(
+    const BoxGraph& box_graph,
+    const torch::Tensor& scores,
+    sequence_state_t& state,
+    const int& first_dirty_frame,
+    const int& last_dirty_frame) {
+    /*
+    Updates @state after the edges or scores of frames @first_dirty_frame to @last_dirty_frame have changed.
 
-    // reverse sequence roots since built sequences from back to front
-    std::reverse(sequence_roots.begin(), sequence_roots.end());
+    The dirty frames are always recomputed. Since the DP runs backwards, the frames before @first_dirty_frame are then
+    recomputed until the best path scores of a frame stop changing, after which the remaining frames are unaffected.
 
-    return find_highest_score_sequence(sequence_roots);
+    Returns the number of boxes whose best paths were recomputed.
+    */
+
+    int num_frames = box_graph.num_frames();
+    int frame_idx = std::min(last_dirty_frame, num_frames - 1);
+    int last_root_frame = std::min(frame_idx + 1, num_frames - 1);
+
+    int64_t num_visited = 0;
+    bool changed = true;
+    while ((frame_idx >= 0) && ((frame_idx >= first_dirty_frame) || changed)) {
+        changed = update_frame(box_graph, scores, state, frame_idx);
+        num_visited += box_graph.num_boxes(frame_idx);
+        frame_idx--;
+    }
+
+    // roots depend on the best path scores of their frame and on the edges of the frame before
+    for (int f_idx = frame_idx + 1; f_idx <= last_root_frame; f_idx++) {
+        update_frame_best_root(box_graph, state, f_idx);
+    }
+
+    return num_visited;
 }
 
-void rescore_sequence(
-    const std::vector<int>& sequence,
-    torch::Tensor& scores,
+std::vector<int> trace_sequence(
+    const BoxGraph& box_graph,
+    const sequence_state_t& state,
     const int& sequence_frame_index,
-    const float& max_sum,
-    const ScoreMetric& metric) {
+    const int& box_idx) {
     /*
-    Given a sequence, rescore the scores either by:
-        - Average max_sum among sequence's elements (ScoreMetric::avg).
-        - Find the max value among the sequence's elements, and set all values to that (ScoreMetric::max).
+    Rebuilds the best path starting at box @box_idx of frame @sequence_frame_index by following the predecessors in
+    @state. Returns an empty sequence if @box_idx is -1.
     */
 
-    auto scores_acc = scores.accessor<float, 2>();
+    std::vector<int> sequence;
+    trace_sequence(box_graph, state, sequence_frame_index, box_idx, sequence);
+    return sequence;
+}
 
-    if (metric == ScoreMetric::avg) {
-        float avg_score = max_sum / static_cast<float>(sequence.size());
+void trace_sequence(
+    const BoxGraph& box_graph,
+    const sequence_state_t& state,
+    const int& sequence_frame_index,
+    const int& box_idx,
+    std::vector<int>& sequence) {
+    /*
+    Same as trace_sequence(box_graph, state, sequence_frame_index, box_idx), but overwrites @sequence and reuses its
+    memory.
+    */
 
-        for (int i = 0; i < sequence.size(); i++) {
-            int box_idx = sequence[i];
-            scores_acc[sequence_frame_index + i][box_idx] = avg_score;
-        }
+    sequence.clear();
+    for (int f_idx = sequence_frame_index, b_idx = box_idx; b_idx >= 0; f_idx++) {
+        sequence.push_back(b_idx);
+        b_idx = state.predecessors[box_graph.frame_offset(f_idx) + b_idx];
+    }
+}
+
+std::tuple<int, std::vector<int>, float> find_best_sequence(const BoxGraph& box_graph, const sequence_state_t& state) {
+    /*
+    Finds the highest scoring sequence given the solved @state, see trace_sequence.
+    */
+
+    auto best_root = find_highest_score_sequence(state.frame_best_roots);
+    int sequence_frame_index = std::get<0>(best_root);
+    std::vector<int> best_sequence = trace_sequence(box_graph, state, sequence_frame_index, std::get<1>(best_root));
+
+    return std::make_tuple(sequence_frame_index, best_sequence, std::get<2>(best_root));
+}
+
+std::tuple<int, std::vector<int>, float> find_best_sequence(const BoxGraph& box_graph, const torch::Tensor& scores) {
+    /*
+    A function for finding the best path through the graph @box_graph.
+    The best path is the one that has the highest cumulative sum.
+    We dynamically build up best paths through graph starting from the end frame such that we can determine the beginning of
+    sequences. For example if there are no links to a box from previous frames, then it is a candidate for starting a sequence.
+    Only the score and the next box of each box's best path is stored, see sequence_state_t.
+    */
+
+    sequence_state_t state = init_sequence_state(box_graph, scores);
+    return find_best_sequence(box_graph, state);
+}
+
+template <ScoreMetric metric>
+static float sequence_score(
+    const std::vector<int>& sequence,
+    const torch::Tensor& scores,
+    const int& sequence_frame_index,
+    const float& max_sum) {
+    /*
+    Returns the score every box of @sequence is rescored to, see rescore_sequence. The metric is a template argument so
+    each metric gets its own code without a branch.
+    */
+
+    if constexpr (metric == ScoreMetric::avg) {
+        return max_sum / static_cast<float>(sequence.size());
     } else {
-        // metric == ScoreMetric::max
+        auto scores_acc = scores.accessor<float, 2>();
         float max_score = 0.0;
 
         for (int i = 0; i < sequence.size(); i++) {
@@ -156,61 +339,93 @@ void rescore_sequence(
                 max_score = scores_acc[sequence_frame_index + i][box_idx];
             }
         }
+        return max_score;
+    }
+}
 
-        for (int i = 0; i < sequence.size(); i++) {
-            int box_idx = sequence[i];
-            scores_acc[sequence_frame_index + i][box_idx] = max_score;
-        }
+void rescore_sequence(
+    const std::vector<int>& sequence,
+    torch::Tensor& scores,
+    const int& sequence_frame_index,
+    const float& max_sum,
+    const ScoreMetric& metric) {
+    /*
+    Given a sequence, rescore the scores either by:
+        - Average max_sum among sequence's elements (ScoreMetric::avg).
+        - Find the max value among the sequence's elements, and set all values to that (ScoreMetric::max).
+    */
+
+    float score = metric == ScoreMetric::avg
+                      ? sequence_score<ScoreMetric::avg>(sequence, scores, sequence_frame_index, max_sum)
+                      : sequence_score<ScoreMetric::max>(sequence, scores, sequence_frame_index, max_sum);
+
+    auto scores_acc = scores.accessor<float, 2>();
+    for (int i = 0; i < sequence.size(); i++) {
+        int box_idx = sequence[i];
+        scores_acc[sequence_frame_index + i][box_idx] = score;
     }
 }
 
 void delete_sequence(
     const std::vector<int>& sequence,
     const int& sequence_frame_index,
-    const torch::Tensor& scores,
-    const torch::Tensor& boxes,
-    const torch::Tensor& box_areas,
-    box_seq_t& box_graph,
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
     const float& iou_threshold) {
     /*
     Given a sequence, remove connections in @box_graph which have iou higher than @iou_threshold
         with index @sequence_frame_index.
     */
 
-    for (int s_idx = 0; s_idx < sequence.size(); s_idx++) {
-        int box_idx = sequence[s_idx];
+    std::vector<int> delete_indicies;
+    delete_sequence(sequence, sequence_frame_index, boxes, box_graph, iou_threshold, delete_indicies);
+}
 
-        torch::Tensor other_boxes = boxes.index({sequence_frame_index + s_idx, Slice(), Slice()});
-        torch::Tensor other_areas = box_areas.index({sequence_frame_index + s_idx, Slice()});
+void delete_sequence(
+    const std::vector<int>& sequence,
+    const int& sequence_frame_index,
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    const float& iou_threshold,
+    std::vector<int>& delete_indicies) {
+    /*
+    Same as delete_sequence(sequence, sequence_frame_index, boxes, box_graph, iou_threshold), @delete_indicies is a
+    buffer which can be reused between calls.
+    */
 
-        torch::Tensor seq_box = boxes.index({sequence_frame_index + s_idx, box_idx, Slice()});
-        seq_box = seq_box.unsqueeze(0);
-        torch::Tensor seq_box_area = box_areas.index({sequence_frame_index + s_idx, box_idx});
-        seq_box_area = seq_box_area.unsqueeze(0);
+    for (int s_idx = 0; s_idx < sequence.size(); s_idx++) {
+        int frame_idx = sequence_frame_index + s_idx;
 
-        torch::Tensor iou_tensor = calculate_iou_given_area(other_boxes, seq_box, other_areas, seq_box_area);
-        auto iou_acc = iou_tensor.accessor<float, 2>();
+        delete_indicies.clear();
+        find_overlapping_boxes(
+            boxes, boxes.frame_offsets[frame_idx] + sequence[s_idx], frame_idx, iou_threshold, delete_indicies);
 
-        std::vector<int> delete_indicies;
-        for (int i = 0; i < iou_tensor.size(0); i++) {
-            if (iou_acc[0][i] >= iou_threshold) {
-                delete_indicies.push_back(i);
-            }
+        // removing a box from the graph also removes its connections from the previous frame
+        for (int delete_idx : delete_indicies) {
+            box_graph.remove_box(frame_idx, delete_idx);
         }
+    }
+}
 
-        if (sequence_frame_index + s_idx < box_graph.size()) {
-            for (int delete_idx : delete_indicies) {
-                box_graph[sequence_frame_index + s_idx][delete_idx].clear();
-            }
-        }
+void delete_sequence(
+    const std::vector<int>& sequence,
+    const int& sequence_frame_index,
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    overlap_index_t& overlaps) {
+    /*
+    Same as delete_sequence, but the boxes overlapping each box of @sequence are looked up in @overlaps, which is
+    expected to be prepared for @boxes at the same iou_threshold, see prepare_overlap_index. The frames of @sequence
+    which aren't in the index yet are built.
+    */
 
-        if ((s_idx > 0) || (sequence_frame_index > 0)) {
-            // remove connections to current sequence node from previous frame
-            for (auto& prior_box : box_graph[sequence_frame_index + s_idx - 1]) {
-                for (int delete_idx : delete_indicies) {
-                    prior_box.erase(std::remove(prior_box.begin(), prior_box.end(), delete_idx), prior_box.end());
-                }
-            }
+    for (int s_idx = 0; s_idx < sequence.size(); s_idx++) {
+        int frame_idx = sequence_frame_index + s_idx;
+        const frame_overlaps_t& frame_overlaps = get_frame_overlaps(boxes, frame_idx, overlaps);
+
+        int box_idx = sequence[s_idx];
+        for (int i = frame_overlaps.offsets[box_idx]; i < frame_overlaps.offsets[box_idx + 1]; i++) {
+            box_graph.remove_box(frame_idx, frame_overlaps.boxes[i]);
         }
     }
 }
@@ -2,11 +2,43 @@
 #include <torch/torch.h>
 #include <tuple>
 #include <vector>
+#include "box_graph.h"
+#include "box_utils.h"
 #include "custom_types.h"
 
-std::tuple<int, std::vector<int>, float> find_highest_score_sequence(const std::vector<score_indicies_list>& sequence_roots);
+std::tuple<int, int, float> find_highest_score_sequence(const std::vector<std::tuple<float, int>>& frame_best_roots);
 
-std::tuple<int, std::vector<int>, float> find_best_sequence(const box_seq_t& box_graph, const torch::Tensor& scores);
+sequence_state_t init_sequence_state(const BoxGraph& box_graph, const torch::Tensor& scores);
+
+void init_sequence_state(const BoxGraph& box_graph, const torch::Tensor& scores, sequence_state_t& state);
+
+void append_frame(const BoxGraph& box_graph, sequence_state_t& state);
+
+void remove_first_frame(const BoxGraph& box_graph, sequence_state_t& state);
+
+int64_t update_sequence_state(
+    const BoxGraph& box_graph,
+    const torch::Tensor& scores,
+    sequence_state_t& state,
+    const int& first_dirty_frame,
+    const int& last_dirty_frame);
+
+std::vector<int> trace_sequence(
+    const BoxGraph& box_graph,
+    const sequence_state_t& state,
+    const int& sequence_frame_index,
+    const int& box_idx);
+
+void trace_sequence(
+    const BoxGraph& box_graph,
+    const sequence_state_t& state,
+    const int& sequence_frame_index,
+    const int& box_idx,
+    std::vector<int>& sequence);
+
+std::tuple<int, std::vector<int>, float> find_best_sequence(const BoxGraph& box_graph, const sequence_state_t& state);
+
+std::tuple<int, std::vector<int>, float> find_best_sequence(const BoxGraph& box_graph, const torch::Tensor& scores);
 
 void rescore_sequence(
     const std::vector<int>& sequence,
@@ -18,8 +50,21 @@ void rescore_sequence(
 void delete_sequence(
     const std::vector<int>& sequence,
     const int& sequence_frame_index,
-    const torch::Tensor& scores,
-    const torch::Tensor& boxes,
-    const torch::Tensor& box_areas,
-    box_seq_t& box_graph,
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
     const float& iou_threshold);
+
+void delete_sequence(
+    const std::vector<int>& sequence,
+    const int& sequence_frame_index,
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    const float& iou_threshold,
+    std::vector<int>& delete_indicies);
+
+void delete_sequence(
+    const std::vector<int>& sequence,
+    const int& sequence_frame_index,
+    const boxes_soa_t& boxes,
+    BoxGraph& box_graph,
+    overlap_index_t& overlaps);
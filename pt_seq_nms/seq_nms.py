@@ -1,4 +1,4 @@
-from typing import List, Tuple
+from typing import Dict, List, Optional, Tuple
 
 import torch
 
@@ -16,7 +16,10 @@ def _all_same_types(types: List[str]) -> bool:
 
 def _validate_tensor_types(boxes: torch.Tensor, scores: torch.Tensor, classes: torch.Tensor) -> None:
     """
-    Utility function for validating that the boxes, scores and classes have the same type.
+    Utility function for validating that the boxes, scores and classes have supported types and are on the same device.
+
+    Boxes and scores can be float16, bfloat16, float32 or float64 and classes int32 or int64, they don't need to be
+    converted before calling seq-nms.
 
     Args:
         boxes (Tensor[F, N, 4]) Boxes to perform seq-nms on. They are expected to be in
@@ -26,9 +29,11 @@ def _validate_tensor_types(boxes: torch.Tensor, scores: torch.Tensor, classes: t
     Returns:
     """
 
-    assert boxes.dtype == torch.float32, f"boxes are expected to have dtype float32, got {boxes.dtype}"
-    assert scores.dtype == torch.float32, f"scores are expected to have dtype float32, got {scores.dtype}"
-    assert classes.dtype == torch.int32, f"classes are expected to have dtype int32, got {classes.dtype}"
+    assert boxes.is_floating_point(), f"boxes are expected to have a floating point dtype, got {boxes.dtype}"
+    assert scores.is_floating_point(), f"scores are expected to have a floating point dtype, got {scores.dtype}"
+    assert (
+        classes.dtype == torch.int32 or classes.dtype == torch.int64
+    ), f"classes are expected to have dtype int32 or int64, got {classes.dtype}"
     assert _all_same_types(
         [boxes.device.type, scores.device.type, classes.device.type]
     ), "Expected all of the tensors to be on the same device"
@@ -50,6 +55,34 @@ def _validate_auxiliary_params(linkage_threshold: float, iou_threshold: float, m
     assert metrics in ("avg", "max"), f"Expected metrics to be in {('avg', 'max')}, got {metrics}"
 
 
+def _validate_pruning_params(max_boxes_per_frame: Optional[int]) -> None:
+    """
+    Utility function for validating that the candidate pruning parameters are in the valid range.
+
+    Args:
+        max_boxes_per_frame (int, optional): the number of highest scoring boxes of each frame taking part in seq-nms.
+    Returns:
+    """
+
+    if max_boxes_per_frame is not None:
+        assert max_boxes_per_frame >= 0, f"max_boxes_per_frame should be >= 0; got {max_boxes_per_frame}"
+
+
+def _validate_chunk_params(chunk_size: Optional[int], chunk_overlap: int) -> None:
+    """
+    Utility function for validating that the chunking parameters are in the valid range.
+
+    Args:
+        chunk_size (int, optional): the number of frames of a chunk.
+        chunk_overlap (int): the number of frames shared by consecutive chunks.
+    Returns:
+    """
+
+    if chunk_size is not None:
+        assert chunk_size >= 1, f"chunk_size should be >= 1; got {chunk_size}"
+        assert 0 <= chunk_overlap < chunk_size, f"chunk_overlap should be >= 0 and < chunk_size; got {chunk_overlap}"
+
+
 def seq_nms(
     boxes: torch.Tensor,
     scores: torch.Tensor,
@@ -57,6 +90,13 @@ def seq_nms(
     linkage_threshold: float,
     iou_threshold: float,
     metrics: str = "avg",
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
+    chunk_size: Optional[int] = None,
+    chunk_overlap: int = 0,
+    out: Optional[torch.Tensor] = None,
 ) -> torch.Tensor:
     """
     Applies the seq-nms algorithm to the input boxes.
@@ -71,6 +111,22 @@ def seq_nms(
         linkage_threshold (float): The threshold for linking two objects in consecutive frames.
         iou_threshold (float): the threshold for considering two boxes to be overlapping.
         metric (str): the metric type, currently "avg" and "max" is supported.
+        class_aware (bool): whether a sequence only suppresses boxes of its own class, the classes are then
+            rescored independently and in parallel. By default a sequence suppresses overlapping boxes of every class.
+        disjoint_sequences (bool): whether every sequence which doesn't conflict with a higher scoring one is taken
+            before the best paths are recomputed. Much faster on clips with many independent objects, but sequences
+            can be taken in a different order than by default, which can change the result.
+        score_threshold (float, optional): if set, only boxes with at least this score take part in seq-nms.
+        max_boxes_per_frame (int, optional): if set, only this many of the highest scoring boxes of each frame take
+            part in seq-nms. Boxes left out by either keep their scores.
+        chunk_size (int, optional): if set, the clip is rescored chunk_size frames at a time, so the memory of seq-nms
+            only depends on chunk_size rather than on F. Sequences crossing from one chunk to the next are stitched
+            together. The result is the same as without chunks if F <= chunk_size, otherwise it can differ near the
+            chunk boundaries, see seq_nms_chunked in seq_nms.cpp.
+        chunk_overlap (int): the number of frames shared by consecutive chunks, every frame is rescored with at least
+            chunk_overlap // 2 frames of context on either side. Stitching sequences needs at least 2.
+        out (Tensor, optional): if set, the updated scores are written to out, which is resized to (F, N), and out is
+            returned. Not supported together with chunk_size.
     Returns:
         updated_scores (Tensor): tensor with the updated scores, i.e. the scores after they have been
             updated according to seq-nms.
@@ -82,58 +138,540 @@ def seq_nms(
 
     _validate_tensor_types(boxes, scores, classes)
     _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+    _validate_chunk_params(chunk_size, chunk_overlap)
+
+    if chunk_size is not None:
+        assert out is None, "out is not supported together with chunk_size"
+        chunked_scores: torch.Tensor = torch.ops.seq_nms.seq_nms_chunked(
+            boxes,
+            scores,
+            classes,
+            linkage_threshold,
+            iou_threshold,
+            metrics,
+            class_aware,
+            disjoint_sequences,
+            score_threshold,
+            max_boxes_per_frame,
+            chunk_size=chunk_size,
+            chunk_overlap=chunk_overlap,
+        )
+        return chunked_scores
+
+    if out is not None:
+        out_scores: torch.Tensor = torch.ops.seq_nms.seq_nms.out(
+            boxes,
+            scores,
+            classes,
+            linkage_threshold,
+            iou_threshold,
+            metrics,
+            class_aware,
+            disjoint_sequences,
+            score_threshold,
+            max_boxes_per_frame,
+            out=out,
+        )
+        return out_scores
+
+    updated_scores: torch.Tensor = torch.ops.seq_nms.seq_nms(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metrics,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+    )
+    return updated_scores
+
 
-    updated_scores: torch.Tensor = torch.ops.seq_nms.seq_nms(boxes, scores, classes, linkage_threshold, iou_threshold, metrics)
+def seq_nms_batched(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metrics: str = "avg",
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
+) -> torch.Tensor:
+    """
+    Applies the seq-nms algorithm to a batch of clips, the clips are processed in parallel.
+
+    Below B is the number of clips, F is the number of frames and N is the number of objects per frame.
+    Boxes with a class < 0 are considered padding.
+
+    Args:
+        boxes (Tensor[B, F, N, 4]) Boxes to perform seq-nms on. They are expected to be in
+           (x_min, y_min, x_max, y_max) format.
+        scores (Tensor[B, F, N]): Scores for each one of the boxes.
+        classes (Tensor[B, F, N]): Class for each one of the boxes.
+        linkage_threshold (float): The threshold for linking two objects in consecutive frames.
+        iou_threshold (float): the threshold for considering two boxes to be overlapping.
+        metric (str): the metric type, currently "avg" and "max" is supported.
+        class_aware (bool): whether a sequence only suppresses boxes of its own class, the classes are then
+            rescored independently and in parallel. By default a sequence suppresses overlapping boxes of every class.
+        disjoint_sequences (bool): whether every sequence which doesn't conflict with a higher scoring one is taken
+            before the best paths are recomputed. Much faster on clips with many independent objects, but sequences
+            can be taken in a different order than by default, which can change the result.
+        score_threshold (float, optional): if set, only boxes with at least this score take part in seq-nms.
+        max_boxes_per_frame (int, optional): if set, only this many of the highest scoring boxes of each frame take
+            part in seq-nms. Boxes left out by either keep their scores.
+    Returns:
+        updated_scores (Tensor[B, F, N]): tensor with the updated scores, where clip b is the same as
+            seq_nms(boxes[b], scores[b], classes[b], ...).
+    """
+
+    assert len(boxes.shape) == 4 and boxes.shape[-1] == 4, f"boxes has wrong shape, expected (B, F, N, 4), got {boxes.shape}"
+    assert len(scores.shape) == 3, f"scores has wrong shape, expected (B, F, N) got {scores.shape}"
+    assert len(classes.shape) == 3, f"classes has wrong shape, expected (B, F, N) got {classes.shape}"
+
+    _validate_tensor_types(boxes, scores, classes)
+    _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+
+    updated_scores: torch.Tensor = torch.ops.seq_nms.seq_nms_batched(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metrics,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+    )
     return updated_scores
 
 
-def _from_list_to_tensor(
-    boxes_list: List[torch.Tensor],
-    scores_list: List[torch.Tensor],
-    classes_list: List[torch.Tensor],
-) -> Tuple[torch.Tensor, torch.Tensor, torch.Tensor]:
+def seq_nms_packed(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    frame_offsets: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metrics: str = "avg",
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
+) -> torch.Tensor:
     """
-    Converts a list of tensors of different shapes to one tensor by taking the max-length
-        and filling the remaining values with zeros.
+    Applies the seq-nms algorithm to boxes packed frame after frame, frames can have different numbers of boxes.
 
-    For example, if the input is [[1], [2, 3]] the output will be [[1, 0], [2, 3]].
+    Below S is the total number of boxes and F is the number of frames, the boxes of frame f are
+    boxes[frame_offsets[f]:frame_offsets[f + 1]]. Unlike seq_nms_from_list the frames are never padded.
 
-    Below F is the number of frames and N_f is the number of objects per frame (which can vary between frames).
-    M is the maximum length of each box.
+    Args:
+        boxes (Tensor[S, 4]) Boxes to perform seq-nms on. They are expected to be in
+           (x_min, y_min, x_max, y_max) format.
+        scores (Tensor[S]): Scores for each one of the boxes.
+        classes (Tensor[S]): Class for each one of the boxes.
+        frame_offsets (Tensor[F + 1]): Index of the first box of each frame, followed by S.
+        linkage_threshold (float): The threshold for linking two objects in consecutive frames.
+        iou_threshold (float): the threshold for considering two boxes to be overlapping.
+        metric (str): the metric type, currently "avg" and "max" is supported.
+        class_aware (bool): see seq_nms.
+        disjoint_sequences (bool): see seq_nms.
+        score_threshold (float, optional): see seq_nms.
+        max_boxes_per_frame (int, optional): see seq_nms.
+    Returns:
+        updated_scores (Tensor[S]): tensor with the updated scores, in the same layout as scores.
+    """
+
+    assert len(boxes.shape) == 2 and boxes.shape[-1] == 4, f"boxes has wrong shape, expected (S, 4), got {boxes.shape}"
+    assert scores.shape == boxes.shape[:1], f"scores has wrong shape, expected ({boxes.shape[0]},) got {scores.shape}"
+    assert classes.shape == boxes.shape[:1], f"classes has wrong shape, expected ({boxes.shape[0]},) got {classes.shape}"
+    assert len(frame_offsets.shape) == 1, f"frame_offsets has wrong shape, expected (F + 1,) got {frame_offsets.shape}"
+    assert frame_offsets.dtype == torch.int64, f"frame_offsets are expected to have dtype int64, got {frame_offsets.dtype}"
+
+    _validate_tensor_types(boxes, scores, classes)
+    _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+
+    updated_scores: torch.Tensor = torch.ops.seq_nms.seq_nms_packed(
+        boxes,
+        scores,
+        classes,
+        frame_offsets,
+        linkage_threshold,
+        iou_threshold,
+        metrics,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+    )
+    return updated_scores
+
+
+def seq_nms_bounded(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metrics: str = "avg",
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
+    max_sequences: Optional[int] = None,
+    min_sequence_score: Optional[float] = None,
+    deadline_ms: Optional[float] = None,
+) -> Tuple[torch.Tensor, str]:
+    """
+    Same as seq_nms, but stops taking sequences once one of the limits is reached, which bounds the latency on dense
+    clips. The boxes of the sequences taken until then keep their rescored scores, the other boxes keep their scores.
 
     Args:
-        boxes_list (List[F]) Boxes to perform seq-nms on. Each element in the list is a Tensor[N_f, 4].
-            They are expected to be in (x_min, y_min, x_max, y_max) format.
-        scores_list (List[F]) Scores for each one of the boxes. Each element in the list is a Tensor[N_f].
-        classes_list (List[F]): Class for each one of the boxes. Each element in the list is a Tensor[N_f].
+        see seq_nms for the other arguments.
+        max_sequences (int, optional): the number of sequences which are taken, per class if class_aware is set.
+        min_sequence_score (float, optional): the lowest cumulative score, i.e. the sum of the box scores, of a sequence
+            which is taken.
+        deadline_ms (float, optional): the time after the start of the call after which no sequence is taken. It is
+            checked before each sequence, building the graph is not interrupted.
     Returns:
-        boxes (Tensor[F, M, 4]): Concatenated boxes.
-        scores (Tensor[F, M]): Concatenated scores.
-        classes (Tensor[F, M]): Concatenated classes.
+        updated_scores (Tensor): the updated scores, the same as seq_nms if no limit was reached.
+        stop_reason (str): "completed" if no limit was reached, otherwise the limit which stopped seq-nms, i.e.
+            "max_sequences", "min_sequence_score" or "deadline". If class_aware is set, the limit of the first class
+            which stopped early.
     """
 
-    max_length = max([len(b) for b in boxes_list])
-    num_element = len(boxes_list)
-    device = boxes_list[0].device.type if len(boxes_list) > 0 else "cpu"
+    assert len(boxes.shape) == 3 and boxes.shape[-1] == 4, f"boxes has wrong shape, expected (F, N, 4), got {boxes.shape}"
+    assert len(scores.shape) == 2, f"scores has wrong shape, expected (F, N) got {scores.shape}"
+    assert len(classes.shape) == 2, f"classes has wrong shape, expected (F, N) got {classes.shape}"
 
-    boxes = torch.zeros((num_element, max_length, 4), dtype=torch.float32, device=device)
-    scores = torch.zeros((num_element, max_length), dtype=torch.float32, device=device)
-    classes = -1 * torch.ones((num_element, max_length), dtype=torch.int32, device=device)
+    _validate_tensor_types(boxes, scores, classes)
+    _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+    if max_sequences is not None:
+        assert max_sequences >= 0, f"max_sequences should be >= 0; got {max_sequences}"
+    if deadline_ms is not None:
+        assert deadline_ms >= 0.0, f"deadline_ms should be >= 0; got {deadline_ms}"
+
+    result: Tuple[torch.Tensor, str] = torch.ops.seq_nms.seq_nms_bounded(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metrics,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+        max_sequences,
+        min_sequence_score,
+        deadline_ms,
+    )
+    return result
+
+
+def seq_nms_sweep(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    configs: List[Tuple[float, str]],
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
+) -> torch.Tensor:
+    """
+    Applies seq_nms to the same clip once for every (iou_threshold, metrics) configuration, e.g. to tune them. The graph
+    linking the boxes only depends on the linkage threshold, so it is built once and shared by the configurations,
+    which are rescored in parallel.
 
-    for idx in range(len(boxes_list)):
-        len_idx = len(boxes_list[idx])
+    Args:
+        see seq_nms for the other arguments.
+        configs (List[Tuple[float, str]]): the (iou_threshold, metrics) of each configuration.
+    Returns:
+        updated_scores (Tensor): the updated scores with the shape [C, F, N], updated_scores[c] is the same as seq_nms
+            with the configuration configs[c].
+    """
 
-        boxes_idx = boxes_list[idx]
-        scores_idx = scores_list[idx]
-        classes_idx = classes_list[idx]
+    assert len(boxes.shape) == 3 and boxes.shape[-1] == 4, f"boxes has wrong shape, expected (F, N, 4), got {boxes.shape}"
+    assert len(scores.shape) == 2, f"scores has wrong shape, expected (F, N) got {scores.shape}"
+    assert len(classes.shape) == 2, f"classes has wrong shape, expected (F, N) got {classes.shape}"
 
-        _validate_tensor_types(boxes_idx, scores_idx, classes_idx)
+    _validate_tensor_types(boxes, scores, classes)
+    _validate_auxiliary_params(linkage_threshold, 0.0)
+    for iou_threshold, metrics in configs:
+        _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+
+    updated_scores: torch.Tensor = torch.ops.seq_nms.seq_nms_sweep(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        [iou_threshold for iou_threshold, _ in configs],
+        [metrics for _, metrics in configs],
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+    )
+    return updated_scores
 
-        boxes[idx, 0:len_idx, :] = boxes_idx
-        scores[idx, 0:len_idx] = scores_idx
-        classes[idx, 0:len_idx] = classes_idx
 
-    return boxes, scores, classes
+def seq_nms_async(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metrics: str = "avg",
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
+) -> torch.jit.Future[torch.Tensor]:
+    """
+    Same as seq_nms, but returns a future of the updated scores right away and rescores the clip on a thread pool of
+    its own, without holding the GIL, so e.g. the inference of the next clip can overlap with it. The result is waited
+    for with future.wait(), or torch.jit.wait(future) in TorchScript, and errors while rescoring are raised there.
+
+    The boxes and classes are read while the clip is rescored, so they should be left unchanged until the future is
+    done. The scores are copied by the call.
+
+    Args:
+        see seq_nms.
+    Returns:
+        future (Future[Tensor]): the future of the same updated scores as seq_nms.
+    """
+
+    assert len(boxes.shape) == 3 and boxes.shape[-1] == 4, f"boxes has wrong shape, expected (F, N, 4), got {boxes.shape}"
+    assert len(scores.shape) == 2, f"scores has wrong shape, expected (F, N) got {scores.shape}"
+    assert len(classes.shape) == 2, f"classes has wrong shape, expected (F, N) got {classes.shape}"
+
+    _validate_tensor_types(boxes, scores, classes)
+    _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+
+    future: torch.jit.Future[torch.Tensor] = torch.ops.seq_nms.seq_nms_async(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metrics,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+    )
+    return future
+
+
+def seq_nms_with_stats(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metrics: str = "avg",
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
+) -> Tuple[torch.Tensor, Dict[str, int]]:
+    """
+    Same as seq_nms, but also returns counters which show where the time of the call was spent.
+
+    The phases also show up in torch.profiler traces of seq_nms, as seq_nms::build_box_sequences,
+    seq_nms::find_best_sequence, seq_nms::rescore_sequence and seq_nms::delete_sequence.
+
+    Args:
+        see seq_nms.
+    Returns:
+        updated_scores (Tensor): the same as seq_nms.
+        stats (Dict[str, int]): the counters of the call:
+            iterations: the number of sequences which were rescored.
+            edges_built: the number of links between boxes in consecutive frames.
+            edges_deleted: the number of links removed by suppression.
+            nodes_visited: the number of boxes whose best path was computed, summed over all updates of the best paths.
+            build_ns, dp_ns, rescore_ns, delete_ns: the nanoseconds spent building the graph, finding the best
+                sequences, rescoring them and suppressing the overlapping boxes, summed over threads.
+            peak_graph_bytes: the bytes allocated by the graph, summed over the classes if class_aware is set.
+            overlap_index_bytes: the bytes allocated by the boxes overlapping each box, which are found once per frame
+                the first time a sequence through the frame is suppressed, summed the same way. 0 if iou_threshold is 0.
+            buffer_growths: the number of times a buffer of the extraction had to grow after the first solve of the best
+                paths. It doesn't grow with the number of sequences, the buffers are sized for the clip and reused.
+    """
+
+    assert len(boxes.shape) == 3 and boxes.shape[-1] == 4, f"boxes has wrong shape, expected (F, N, 4), got {boxes.shape}"
+    assert len(scores.shape) == 2, f"scores has wrong shape, expected (F, N) got {scores.shape}"
+    assert len(classes.shape) == 2, f"classes has wrong shape, expected (F, N) got {classes.shape}"
+
+    _validate_tensor_types(boxes, scores, classes)
+    _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+
+    result: Tuple[torch.Tensor, Dict[str, int]] = torch.ops.seq_nms.seq_nms_with_stats(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metrics,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+    )
+    return result
+
+
+def seq_nms_with_sequences(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metrics: str = "avg",
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
+) -> Tuple[torch.Tensor, torch.Tensor, torch.Tensor, torch.Tensor]:
+    """
+    Same as seq_nms, but also returns the sequences which were rescored, so they can be used as tracks without linking
+    the boxes again.
+
+    Args:
+        see seq_nms.
+    Returns:
+        updated_scores (Tensor[F, N]): the same as seq_nms.
+        sequence_ids (Tensor[F, N]): the sequence each box was rescored by, or -1 if it is in none (e.g. a suppressed
+            box). Sequences are numbered in the order they were taken, by class first if class_aware is set.
+        sequence_scores (Tensor[S]): the score the boxes of each sequence were rescored to, S is the number of sequences.
+        sequence_lengths (Tensor[S]): the number of boxes of each sequence, they are in consecutive frames.
+    """
+
+    assert len(boxes.shape) == 3 and boxes.shape[-1] == 4, f"boxes has wrong shape, expected (F, N, 4), got {boxes.shape}"
+    assert len(scores.shape) == 2, f"scores has wrong shape, expected (F, N) got {scores.shape}"
+    assert len(classes.shape) == 2, f"classes has wrong shape, expected (F, N) got {classes.shape}"
+
+    _validate_tensor_types(boxes, scores, classes)
+    _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+
+    result: Tuple[torch.Tensor, torch.Tensor, torch.Tensor, torch.Tensor] = torch.ops.seq_nms.seq_nms_with_sequences(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metrics,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+    )
+    return result
+
+
+def seq_nms_(
+    boxes: torch.Tensor,
+    scores: torch.Tensor,
+    classes: torch.Tensor,
+    linkage_threshold: float,
+    iou_threshold: float,
+    metrics: str = "avg",
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
+    workspace: Optional[torch.ScriptObject] = None,
+) -> torch.Tensor:
+    """
+    Same as seq_nms, but writes the updated scores to scores instead of a new tensor.
+
+    Passing the same workspace to every call, e.g. of a serving loop, reuses the memory of the previous calls, so a
+    clip no larger than the ones before it is rescored without allocating.
+
+    Args:
+        see seq_nms.
+        workspace (torch.classes.seq_nms.SeqNmsWorkspace, optional): the working memory of the call, see
+            seq_nms_workspace. A workspace must not be used by two calls at the same time.
+    Returns:
+        scores (Tensor): the scores, updated according to seq-nms.
+    """
+
+    assert len(boxes.shape) == 3 and boxes.shape[-1] == 4, f"boxes has wrong shape, expected (F, N, 4), got {boxes.shape}"
+    assert len(scores.shape) == 2, f"scores has wrong shape, expected (F, N) got {scores.shape}"
+    assert len(classes.shape) == 2, f"classes has wrong shape, expected (F, N) got {classes.shape}"
+
+    _validate_tensor_types(boxes, scores, classes)
+    _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+
+    updated_scores: torch.Tensor = torch.ops.seq_nms.seq_nms_(
+        boxes,
+        scores,
+        classes,
+        linkage_threshold,
+        iou_threshold,
+        metrics,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+        workspace,
+    )
+    return updated_scores
+
+
+def seq_nms_stream(linkage_threshold: float, iou_threshold: float, lookahead: int, metrics: str = "avg") -> torch.ScriptObject:
+    """
+    Creates a stream which applies the seq-nms algorithm to frames as they arrive, e.g. from a live video.
+
+    Frames are added with stream.push_frame(boxes, scores, classes), where boxes is a Tensor[N, 4] in
+    (x_min, y_min, x_max, y_max) format and scores and classes are Tensor[N]. N can vary between frames.
+    A frame is finalized once lookahead newer frames have been pushed, push_frame then returns a list with its
+    updated scores (otherwise an empty list). stream.flush() finalizes and returns the remaining frames.
+
+    Args:
+        linkage_threshold (float): The threshold for linking two objects in consecutive frames.
+        iou_threshold (float): the threshold for considering two boxes to be overlapping.
+        lookahead (int): the number of newer frames seen before a frame is finalized.
+        metric (str): the metric type, currently "avg" and "max" is supported.
+    Returns:
+        stream (torch.classes.seq_nms.SeqNmsStream): the stream.
+    """
+
+    _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
+    assert lookahead >= 0, f"lookahead should be >= 0; got {lookahead}"
+
+    stream: torch.ScriptObject = torch.classes.seq_nms.SeqNmsStream(linkage_threshold, iou_threshold, metrics, lookahead)
+    return stream
+
+
+def seq_nms_workspace() -> torch.ScriptObject:
+    """
+    Creates a workspace which keeps the memory of seq_nms_ between calls.
+
+    The workspace grows to the largest clip it was used for, workspace.num_bytes() returns the number of bytes it
+    holds and workspace.clear() frees them.
+
+    Returns:
+        workspace (torch.classes.seq_nms.SeqNmsWorkspace): the workspace.
+    """
+
+    workspace: torch.ScriptObject = torch.classes.seq_nms.SeqNmsWorkspace()
+    return workspace
 
 
 def seq_nms_from_list(
@@ -143,6 +681,10 @@ def seq_nms_from_list(
     linkage_threshold: float,
     iou_threshold: float,
     metrics: str = "avg",
+    class_aware: bool = False,
+    disjoint_sequences: bool = False,
+    score_threshold: Optional[float] = None,
+    max_boxes_per_frame: Optional[int] = None,
 ) -> torch.Tensor:
     """
     Applies the seq-nms algorithm to a list of input boxes, which can have different shapes.
@@ -157,14 +699,58 @@ def seq_nms_from_list(
         linkage_threshold (float): The threshold for linking two objects in consecutive frames.
         iou_threshold (float): the threshold for considering two boxes to be overlapping.
         metric (str): the metric type, currently "avg" and "max" is supported.
+        class_aware (bool): whether a sequence only suppresses boxes of its own class, the classes are then
+            rescored independently and in parallel. By default a sequence suppresses overlapping boxes of every class.
+        disjoint_sequences (bool): whether every sequence which doesn't conflict with a higher scoring one is taken
+            before the best paths are recomputed. Much faster on clips with many independent objects, but sequences
+            can be taken in a different order than by default, which can change the result.
+        score_threshold (float, optional): if set, only boxes with at least this score take part in seq-nms.
+        max_boxes_per_frame (int, optional): if set, only this many of the highest scoring boxes of each frame take
+            part in seq-nms. Boxes left out by either keep their scores.
     Returns:
         updated_scores (Tensor): tensor with the updated scores, i.e. the scores after they have been
             updated according to seq-nms.
     """
 
     _validate_auxiliary_params(linkage_threshold, iou_threshold, metrics)
-
-    boxes, scores, classes = _from_list_to_tensor(boxes_list, scores_list, classes_list)
-
-    updated_scores: torch.Tensor = torch.ops.seq_nms.seq_nms(boxes, scores, classes, linkage_threshold, iou_threshold, metrics)
+    _validate_pruning_params(max_boxes_per_frame)
+
+    num_frames = len(boxes_list)
+    device = boxes_list[0].device if num_frames > 0 else torch.device("cpu")
+    for idx in range(num_frames):
+        _validate_tensor_types(boxes_list[idx], scores_list[idx], classes_list[idx])
+
+    frame_sizes = torch.tensor([len(b) for b in boxes_list], dtype=torch.int64, device=device)
+    frame_offsets = torch.zeros((num_frames + 1,), dtype=torch.int64, device=device)
+    frame_offsets[1:] = torch.cumsum(frame_sizes, dim=0)
+
+    # the elements are flattened first, so e.g. scores of the shape [1, N_f] are accepted as well
+    if num_frames > 0:
+        boxes = torch.cat([b.reshape(-1, 4) for b in boxes_list])
+        scores = torch.cat([s.reshape(-1) for s in scores_list])
+        classes = torch.cat([c.reshape(-1) for c in classes_list])
+    else:
+        boxes = torch.zeros((0, 4), dtype=torch.float32, device=device)
+        scores = torch.zeros((0,), dtype=torch.float32, device=device)
+        classes = torch.zeros((0,), dtype=torch.int32, device=device)
+
+    packed_scores: torch.Tensor = torch.ops.seq_nms.seq_nms_packed(
+        boxes,
+        scores,
+        classes,
+        frame_offsets,
+        linkage_threshold,
+        iou_threshold,
+        metrics,
+        class_aware,
+        disjoint_sequences,
+        score_threshold,
+        max_boxes_per_frame,
+    )
+
+    # only the returned scores are padded, every frame to the largest number of boxes with zeros
+    max_length = int(frame_sizes.max()) if num_frames > 0 else 0
+    mask = torch.arange(max_length, device=device)[None, :] < frame_sizes[:, None]
+    updated_scores = torch.zeros((num_frames, max_length), dtype=packed_scores.dtype, device=device)
+    updated_scores[mask] = packed_scores
     return updated_scores
@@ -0,0 +1,73 @@
+import argparse
+import json
+import sys
+
+TIME_UNITS = {"ns": 1e-9, "us": 1e-6, "ms": 1e-3, "s": 1.0}
+
+
+def load_benchmarks(path, metric):
+    """
+    Loads the Google Benchmark JSON output at path and returns the time in seconds of every benchmark by name.
+
+    If the benchmarks were run with repetitions, the median of the repetitions is used.
+    """
+
+    with open(path) as f:
+        benchmarks = json.load(f)["benchmarks"]
+
+    times = {}
+    medians = {}
+    for benchmark in benchmarks:
+        name = benchmark.get("run_name", benchmark["name"])
+        seconds = benchmark[metric] * TIME_UNITS[benchmark.get("time_unit", "ns")]
+        if benchmark.get("run_type") == "aggregate":
+            if benchmark.get("aggregate_name") == "median":
+                medians[name] = seconds
+        elif name not in times:
+            times[name] = seconds
+
+    times.update(medians)
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flags the benchmarks which got slower than in a stored baseline.")
+    parser.add_argument("baseline", help="Google Benchmark JSON output of the baseline")
+    parser.add_argument("current", help="Google Benchmark JSON output to compare against the baseline")
+    parser.add_argument("--threshold", type=float, default=0.1, help="relative slowdown flagged as a regression")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="real_time")
+    args = parser.parse_args()
+
+    baseline = load_benchmarks(args.baseline, args.metric)
+    current = load_benchmarks(args.current, args.metric)
+
+    width = max(len(name) for name in list(baseline) + list(current) + ["benchmark"])
+    regressions = []
+    print(f"{'benchmark':<{width}} {'baseline':>12} {'current':>12} {'change':>9}")
+    for name, current_time in current.items():
+        if name not in baseline:
+            print(f"{name:<{width}} {'-':>12} {current_time * 1e3:>10.4f}ms {'new':>9}")
+            continue
+
+        baseline_time = baseline[name]
+        change = current_time / baseline_time - 1.0 if baseline_time > 0.0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = " REGRESSION"
+            regressions.append(name)
+
+        print(f"{name:<{width}} {baseline_time * 1e3:>10.4f}ms {current_time * 1e3:>10.4f}ms {change:>+8.1%}{flag}")
+
+    for name in baseline:
+        if name not in current:
+            print(f"{name:<{width}} {baseline[name] * 1e3:>10.4f}ms {'-':>12} {'missing':>9}")
+
+    if regressions:
+        print(f"{len(regressions)} of {len(current)} benchmarks are more than {args.threshold:.0%} slower than the baseline")
+        sys.exit(1)
+
+    print(f"no benchmark is more than {args.threshold:.0%} slower than the baseline")
+
+
+if __name__ == "__main__":
+    main()
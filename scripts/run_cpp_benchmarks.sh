@@ -0,0 +1,19 @@
+#!/bin/bash
+
+# Usage: run_cpp_benchmarks.sh [output_json] [baseline_json]
+# Runs the C++ benchmarks and, if a baseline is given, flags the benchmarks which got slower than the baseline.
+
+set -e
+
+current_dir=$(pwd)
+output_json=${1:-benchmarks.json}
+baseline_json=$2
+
+mkdir -p build_release
+(cd build_release && cmake -DCMAKE_PREFIX_PATH="$current_dir/libtorch" -DCMAKE_BUILD_TYPE=Release .. && make -j run_benchmarks)
+
+./build_release/tests/cpp/run_benchmarks --benchmark_out="$output_json" --benchmark_out_format=json
+
+if [ -n "$baseline_json" ]; then
+    python scripts/compare_benchmarks.py "$baseline_json" "$output_json"
+fi
@@ -0,0 +1,46 @@
+import time
+
+import torch
+from speed_test import generate_data
+
+from pt_seq_nms import seq_nms
+
+NUM_ITERS = 5
+NUM_CLASSES = 10
+NUM_FRAMES = 200
+NUM_BOXES = 500
+NUM_THREADS = [1, 2, 4, 8, 16, 32]
+
+
+def time_seq_nms(boxes, scores, classes, linkage_threshold, iou_threshold):
+    # warm-up, so the thread pool is started before timing
+    _ = seq_nms(boxes, scores, classes, linkage_threshold, iou_threshold, "avg")
+
+    start_time = time.time()
+    for _ in range(NUM_ITERS):
+        _ = seq_nms(boxes, scores, classes, linkage_threshold, iou_threshold, "avg")
+    end_time = time.time()
+
+    return (end_time - start_time) / NUM_ITERS
+
+
+def main():
+    linkage_threshold = 0.3
+    iou_threshold = 0.2
+
+    boxes, scores, classes = generate_data(NUM_FRAMES, NUM_BOXES, NUM_CLASSES)
+
+    base_time = None
+    for num_threads in NUM_THREADS:
+        torch.set_num_threads(num_threads)
+        avg_time = time_seq_nms(boxes, scores, classes, linkage_threshold, iou_threshold)
+
+        if base_time is None:
+            base_time = avg_time
+
+        speedup = base_time / avg_time
+        print(f"threads: {num_threads:2d}, took on average: {round(avg_time, 4)} seconds, speedup: {round(speedup, 2)}x")
+
+
+if __name__ == "__main__":
+    main()
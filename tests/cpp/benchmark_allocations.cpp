@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "box_utils.h"
+#include "seq_nms.h"
+#include "seq_nms_workspace.h"
+#include "sequence_utils.h"
+
+/*
+Counts the heap allocations made by each phase of the seq-nms extraction loop, and by whole seq_nms_ calls with a new
+workspace and with a workspace which already rescored the clip.
+
+Usage: run_alloc_benchmark [num_frames] [num_boxes] [num_classes]
+*/
+
+using namespace torch::indexing;
+
+static std::atomic<long> num_allocations{0};
+static std::atomic<long> num_allocated_bytes{0};
+
+void* operator new(std::size_t size) {
+    num_allocations++;
+    num_allocated_bytes += size;
+
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept {
+    std::free(ptr);
+}
+
+struct allocation_counter_t {
+    long allocations = 0;
+    long bytes = 0;
+};
+
+template <typename F>
+void count_allocations(allocation_counter_t& counter, F fn) {
+    long allocations_before = num_allocations;
+    long bytes_before = num_allocated_bytes;
+    fn();
+    counter.allocations += num_allocations - allocations_before;
+    counter.bytes += num_allocated_bytes - bytes_before;
+}
+
+void print_counter(const std::string& name, const allocation_counter_t& counter, const int& num_iterations) {
+    double iterations = std::max(num_iterations, 1);
+    printf("%-24s %20.1f %20.1f\n", name.c_str(), counter.allocations / iterations, counter.bytes / iterations);
+}
+
+int main(int argc, char** argv) {
+    int num_frames = argc > 1 ? std::stoi(argv[1]) : 100;
+    int num_boxes = argc > 2 ? std::stoi(argv[2]) : 20;
+    int num_classes = argc > 3 ? std::stoi(argv[3]) : 10;
+
+    torch::manual_seed(42);
+
+    auto width = 50.0 * torch::rand({num_frames, num_boxes});
+    auto height = 50.0 * torch::rand({num_frames, num_boxes});
+    auto x1 = 50.0 * torch::rand({num_frames, num_boxes});
+    auto y1 = 50.0 * torch::rand({num_frames, num_boxes});
+
+    auto boxes = torch::empty({num_frames, num_boxes, 4});
+    boxes.index({Slice(), Slice(), 0}) = x1;
+    boxes.index({Slice(), Slice(), 1}) = y1;
+    boxes.index({Slice(), Slice(), 2}) = x1 + width;
+    boxes.index({Slice(), Slice(), 3}) = y1 + height;
+
+    auto scores = torch::rand({num_frames, num_boxes});
+    auto classes = torch::randint(0, num_classes, {num_frames, num_boxes}, {torch::kInt32});
+
+    float linkage_threshold = 0.3;
+    float iou_threshold = 0.2;
+
+    allocation_counter_t new_workspace;
+    allocation_counter_t reused_workspace;
+    auto workspace = c10::make_intrusive<SeqNmsWorkspace>();
+    for (auto* counter : {&new_workspace, &reused_workspace}) {
+        torch::Tensor updated_scores = scores.clone();
+        count_allocations(*counter, [&]() {
+            seq_nms_(
+                boxes,
+                updated_scores,
+                classes,
+                linkage_threshold,
+                iou_threshold,
+                "avg",
+                false,
+                false,
+                c10::nullopt,
+                c10::nullopt,
+                workspace);
+        });
+    }
+
+    boxes_soa_t boxes_soa = to_boxes_soa(boxes);
+    BoxGraph box_graph = build_box_sequences(boxes_soa, classes, linkage_threshold);
+    sequence_state_t sequence_state = init_sequence_state(box_graph, scores);
+
+    allocation_counter_t incremental_dp;
+    allocation_counter_t full_dp;
+    allocation_counter_t rescore;
+    allocation_counter_t deletion;
+
+    int num_iterations = 0;
+    while (true) {
+        std::tuple<int, std::vector<int>, float> best_tuple;
+        count_allocations(full_dp, [&]() { find_best_sequence(box_graph, scores); });
+        count_allocations(incremental_dp, [&]() { best_tuple = find_best_sequence(box_graph, sequence_state); });
+
+        int sequence_frame_index = std::get<0>(best_tuple);
+        const std::vector<int>& best_sequence = std::get<1>(best_tuple);
+        float best_score = std::get<2>(best_tuple);
+
+        if (best_sequence.size() <= 1) {
+            break;
+        }
+        num_iterations++;
+
+        count_allocations(rescore, [&]() {
+            rescore_sequence(best_sequence, scores, sequence_frame_index, best_score, ScoreMetric::avg);
+        });
+        count_allocations(deletion, [&]() {
+            delete_sequence(best_sequence, sequence_frame_index, boxes_soa, box_graph, iou_threshold);
+        });
+
+        int first_dirty_frame = std::max(sequence_frame_index - 1, 0);
+        int last_dirty_frame = sequence_frame_index + static_cast<int>(best_sequence.size()) - 1;
+        count_allocations(incremental_dp, [&]() {
+            update_sequence_state(box_graph, scores, sequence_state, first_dirty_frame, last_dirty_frame);
+        });
+    }
+
+    printf("frames: %d, boxes: %d, classes: %d, iterations: %d\n", num_frames, num_boxes, num_classes, num_iterations);
+    printf("%-24s %20s %20s\n", "phase", "allocations/iter", "bytes/iter");
+    print_counter("incremental dp", incremental_dp, num_iterations);
+    print_counter("full dp", full_dp, num_iterations);
+    print_counter("rescore_sequence", rescore, num_iterations);
+    print_counter("delete_sequence", deletion, num_iterations);
+    printf("%-24s %20s %20s\n", "call", "allocations", "bytes");
+    print_counter("seq_nms_ new workspace", new_workspace, 1);
+    print_counter("seq_nms_ reused", reused_workspace, 1);
+
+    return 0;
+}
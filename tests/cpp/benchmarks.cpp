@@ -0,0 +1,201 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <tuple>
+#include <vector>
+#include "box_graph.h"
+#include "box_utils.h"
+#include "seq_nms.h"
+#include "seq_nms_workspace.h"
+#include "sequence_utils.h"
+
+/*
+Micro benchmarks of the seq-nms phases and end-to-end benchmarks of seq_nms, over grids of clip shapes.
+
+The clip arguments are the number of frames F, the number of boxes per frame N, the number of classes C and the box
+density D, the average number of boxes per 100x100 pixels. Boxes are up to 50 pixels wide and high, so the higher the
+density the more boxes overlap and the longer and more entangled the sequences get.
+
+Usage: run_benchmarks --benchmark_out=benchmarks.json --benchmark_out_format=json
+The JSON output can be compared against a baseline with scripts/compare_benchmarks.py.
+*/
+
+const double LINKAGE_THRESHOLD = 0.3;
+const float IOU_THRESHOLD = 0.2;
+
+struct clip_t {
+    torch::Tensor boxes;
+    torch::Tensor scores;
+    torch::Tensor classes;
+};
+
+clip_t generate_clip(const int& num_frames, const int& num_boxes, const int& num_classes, const int& density) {
+    /*
+    Generates a clip of F frames with N uniformly placed boxes each, the side of the image is chosen such that it
+    holds @density boxes per 100x100 pixels on average.
+    */
+
+    torch::manual_seed(42);
+
+    float image_size = 100.0 * std::sqrt(static_cast<float>(num_boxes) / density);
+    auto positions = torch::rand({num_frames, num_boxes, 2});
+    auto sizes = torch::rand({num_frames, num_boxes, 2});
+    auto positions_acc = positions.accessor<float, 3>();
+    auto sizes_acc = sizes.accessor<float, 3>();
+
+    auto boxes = torch::empty({num_frames, num_boxes, 4});
+    auto boxes_acc = boxes.accessor<float, 3>();
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        for (int b_idx = 0; b_idx < num_boxes; b_idx++) {
+            float x1 = image_size * positions_acc[f_idx][b_idx][0];
+            float y1 = image_size * positions_acc[f_idx][b_idx][1];
+            boxes_acc[f_idx][b_idx][0] = x1;
+            boxes_acc[f_idx][b_idx][1] = y1;
+            boxes_acc[f_idx][b_idx][2] = x1 + 50.0 * sizes_acc[f_idx][b_idx][0];
+            boxes_acc[f_idx][b_idx][3] = y1 + 50.0 * sizes_acc[f_idx][b_idx][1];
+        }
+    }
+
+    auto scores = torch::rand({num_frames, num_boxes});
+    auto classes = torch::randint(0, num_classes, {num_frames, num_boxes}, {torch::kInt32});
+    return {boxes, scores, classes};
+}
+
+clip_t generate_clip(const benchmark::State& state) {
+    return generate_clip(state.range(0), state.range(1), state.range(2), state.range(3));
+}
+
+void set_clip_counters(benchmark::State& state) {
+    int64_t num_boxes = state.range(0) * state.range(1);
+    state.counters["boxes"] = static_cast<double>(num_boxes);
+    state.SetItemsProcessed(state.iterations() * num_boxes);
+}
+
+static void BM_calculate_iou_given_area(benchmark::State& state) {
+    // IOU of every box of a frame with every box of the next frame
+    clip_t clip = generate_clip(2, state.range(0), 1, state.range(1));
+    torch::Tensor areas = calculate_area(clip.boxes);
+
+    for (auto _ : state) {
+        torch::Tensor ious = calculate_iou_given_area(clip.boxes[0], clip.boxes[1], areas[0], areas[1]);
+        benchmark::DoNotOptimize(ious);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(0));
+}
+
+static void BM_build_box_sequences(benchmark::State& state) {
+    clip_t clip = generate_clip(state);
+    boxes_soa_t boxes_soa = to_boxes_soa(clip.boxes);
+
+    for (auto _ : state) {
+        BoxGraph box_graph = build_box_sequences(boxes_soa, clip.classes, LINKAGE_THRESHOLD);
+        benchmark::DoNotOptimize(box_graph);
+    }
+    set_clip_counters(state);
+}
+
+static void BM_find_best_sequence(benchmark::State& state) {
+    // the full dynamic programming pass of the first iteration
+    clip_t clip = generate_clip(state);
+    boxes_soa_t boxes_soa = to_boxes_soa(clip.boxes);
+    BoxGraph box_graph = build_box_sequences(boxes_soa, clip.classes, LINKAGE_THRESHOLD);
+
+    for (auto _ : state) {
+        std::tuple<int, std::vector<int>, float> best_tuple = find_best_sequence(box_graph, clip.scores);
+        benchmark::DoNotOptimize(best_tuple);
+    }
+    set_clip_counters(state);
+}
+
+static void BM_delete_sequence(benchmark::State& state) {
+    // removal of the best sequence of the first iteration and of the boxes it suppresses
+    clip_t clip = generate_clip(state);
+    boxes_soa_t boxes_soa = to_boxes_soa(clip.boxes);
+    BoxGraph box_graph = build_box_sequences(boxes_soa, clip.classes, LINKAGE_THRESHOLD);
+
+    std::tuple<int, std::vector<int>, float> best_tuple = find_best_sequence(box_graph, clip.scores);
+    int sequence_frame_index = std::get<0>(best_tuple);
+    const std::vector<int>& best_sequence = std::get<1>(best_tuple);
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        BoxGraph sequence_graph = box_graph;
+        state.ResumeTiming();
+
+        delete_sequence(best_sequence, sequence_frame_index, boxes_soa, sequence_graph, IOU_THRESHOLD);
+        benchmark::ClobberMemory();
+    }
+    state.counters["sequence_length"] = static_cast<double>(best_sequence.size());
+}
+
+static void BM_seq_nms(benchmark::State& state) {
+    clip_t clip = generate_clip(state);
+
+    for (auto _ : state) {
+        torch::Tensor updated_scores = seq_nms(
+            clip.boxes,
+            clip.scores,
+            clip.classes,
+            LINKAGE_THRESHOLD,
+            IOU_THRESHOLD,
+            "avg",
+            false,
+            false,
+            c10::nullopt,
+            c10::nullopt);
+        benchmark::DoNotOptimize(updated_scores);
+    }
+    set_clip_counters(state);
+}
+
+static void BM_seq_nms_workspace(benchmark::State& state) {
+    // seq_nms_ with a workspace reused between the iterations, the copy of the scores matches the one of seq_nms
+    clip_t clip = generate_clip(state);
+    auto workspace = c10::make_intrusive<SeqNmsWorkspace>();
+    torch::Tensor updated_scores = clip.scores.clone();
+
+    for (auto _ : state) {
+        updated_scores.copy_(clip.scores);
+        seq_nms_(
+            clip.boxes,
+            updated_scores,
+            clip.classes,
+            LINKAGE_THRESHOLD,
+            IOU_THRESHOLD,
+            "avg",
+            false,
+            false,
+            c10::nullopt,
+            c10::nullopt,
+            workspace);
+        benchmark::DoNotOptimize(updated_scores);
+    }
+    set_clip_counters(state);
+}
+
+// F, N, C, D
+static void clip_grid(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"F", "N", "C", "D"});
+    b->ArgsProduct({{25, 100, 400}, {20, 100, 500}, {1, 10}, {2, 16}});
+    b->Unit(benchmark::kMicrosecond);
+    // the ops are multithreaded, so the wall time is what a caller sees
+    b->UseRealTime();
+}
+
+// F, N, C, D of clips with wide frames, which are relaxed in parallel by the DP
+static void wide_clip_grid(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"F", "N", "C", "D"});
+    b->ArgsProduct({{16}, {2000, 5000}, {1}, {2, 16}});
+    b->Unit(benchmark::kMicrosecond);
+    b->UseRealTime();
+}
+
+BENCHMARK(BM_calculate_iou_given_area)->ArgNames({"N", "D"})->ArgsProduct({{20, 100, 500}, {2, 16}});
+BENCHMARK(BM_build_box_sequences)->Apply(clip_grid);
+BENCHMARK(BM_find_best_sequence)->Apply(clip_grid);
+BENCHMARK(BM_find_best_sequence)->Apply(wide_clip_grid);
+BENCHMARK(BM_delete_sequence)->Apply(clip_grid);
+BENCHMARK(BM_seq_nms)->Apply(clip_grid);
+BENCHMARK(BM_seq_nms)->Apply(wide_clip_grid);
+BENCHMARK(BM_seq_nms_workspace)->Apply(clip_grid);
+
+BENCHMARK_MAIN();
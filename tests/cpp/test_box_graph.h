@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "box_graph.h"
+
+TEST(box_graph, from_adjacency) {
+    adjacency_list_t adjacency = {{{0, 1}, {}}, {{1}, {0, 1}}};
+    BoxGraph box_graph(adjacency, 2);
+
+    EXPECT_EQ(box_graph.num_frames(), 3);
+    EXPECT_EQ(box_graph.num_nodes(), 6);
+    EXPECT_EQ(box_graph.to_adjacency(), adjacency);
+}
+
+TEST(box_graph, remove_box) {
+    BoxGraph box_graph({{{0, 1}, {}}, {{1}, {0, 1}}}, 2);
+    box_graph.remove_box(1, 1);
+
+    adjacency_list_t expected_adjacency = {{{0}, {}}, {{1}, {}}};
+    EXPECT_EQ(box_graph.to_adjacency(), expected_adjacency);
+    EXPECT_FALSE(box_graph.is_alive(1, 1));
+    EXPECT_TRUE(box_graph.is_alive(1, 0));
+}
+
+TEST(box_graph, restore_boxes) {
+    // 100 boxes in the last frame, so its alive mask has a partial word
+    adjacency_list_t adjacency(1, std::vector<std::vector<int>>(2));
+    adjacency[0][0] = {1, 65, 99};
+    BoxGraph box_graph(adjacency, 100);
+    box_graph.remove_box(0, 0);
+    box_graph.remove_box(1, 99);
+
+    box_graph.restore_boxes();
+    EXPECT_EQ(box_graph.to_adjacency(), adjacency);
+    EXPECT_TRUE(box_graph.is_alive(1, 99));
+    EXPECT_EQ(box_graph.num_edges(), 3);
+}
+
+TEST(box_graph, csr_frame) {
+    // more than BITSET_MAX_BOXES boxes in the next frame, so the edges are stored in CSR layout
+    int num_boxes = 100;
+    adjacency_list_t adjacency(1, std::vector<std::vector<int>>(num_boxes));
+    adjacency[0][0] = {1, 65, 99};
+    adjacency[0][99] = {0};
+
+    BoxGraph box_graph(adjacency, num_boxes);
+    EXPECT_FALSE(box_graph.is_bitset_frame(0));
+    EXPECT_EQ(box_graph.to_adjacency(), adjacency);
+
+    box_graph.remove_box(1, 65);
+    std::vector<int> expected_edges = {1, 99};
+    EXPECT_EQ(box_graph.to_adjacency()[0][0], expected_edges);
+    EXPECT_EQ(box_graph.num_edges(0, 0), 2);
+}
+
+TEST(box_graph, num_edges) {
+    BoxGraph box_graph({{{0, 1}, {}}, {{1}, {0, 1}}}, 2);
+    EXPECT_TRUE(box_graph.is_bitset_frame(0));
+
+    EXPECT_EQ(box_graph.num_edges(0, 0), 2);
+    EXPECT_EQ(box_graph.num_edges(0, 1), 0);
+    EXPECT_EQ(box_graph.num_edges(2, 0), 0);
+
+    box_graph.remove_box(1, 0);
+    EXPECT_EQ(box_graph.num_edges(0, 0), 1);
+    EXPECT_EQ(box_graph.num_edges(1, 0), 0);
+}
+
+TEST(box_graph, total_num_edges) {
+    BoxGraph box_graph({{{0, 1}, {}}, {{1}, {0, 1}}}, 2);
+    EXPECT_EQ(box_graph.num_edges(), 5);
+
+    // box 1 in frame 1 has one incoming and two outgoing edges
+    box_graph.remove_box(1, 1);
+    EXPECT_EQ(box_graph.num_edges(), 2);
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include "box_utils.h"
 
+using namespace torch::indexing;
+
 TEST(calculate_area, area_single_box) {
     auto boxes = torch::tensor({1, 2, 3, 4}, {torch::kFloat32});
     boxes = boxes.view({1, 1, 4});
@@ -46,3 +48,143 @@ TEST(calculate_iou_given_area, iou_overlap) {
 
     ASSERT_TRUE(torch::equal(expected_ious, ious));
 }
+
+TEST(to_boxes_soa, frame_offsets) {
+    auto boxes = torch::tensor({1, 2, 3, 4, 10, 10, 20, 20, 1, 2, 2, 3, 20, 20, 30, 30}, {torch::kFloat32});
+    boxes = boxes.view({2, 2, 4});
+
+    boxes_soa_t boxes_soa = to_boxes_soa(boxes);
+
+    ASSERT_EQ(boxes_soa.frame_offsets, std::vector<int>({0, 2, 4}));
+    ASSERT_EQ(boxes_soa.x1, std::vector<float>({1, 10, 1, 20}));
+    ASSERT_EQ(boxes_soa.y2, std::vector<float>({4, 20, 3, 30}));
+    ASSERT_EQ(boxes_soa.areas, std::vector<float>({4, 100, 1, 100}));
+}
+
+TEST(find_overlapping_boxes_dense, matches_calculate_iou_given_area) {
+    // enough boxes to go through both the vectorized loop and the tail
+    int num_boxes = 37;
+    std::vector<float> box_values;
+    for (int i = 0; i < num_boxes; i++) {
+        float x1 = i % 7;
+        float y1 = i % 5;
+        box_values.insert(box_values.end(), {x1, y1, x1 + 4, y1 + 3});
+    }
+    auto boxes = torch::tensor(box_values, {torch::kFloat32});
+    boxes = boxes.view({1, num_boxes, 4});
+    auto frame_boxes = boxes[0];
+    auto areas = calculate_area(boxes)[0];
+
+    boxes_soa_t boxes_soa = to_boxes_soa(boxes);
+    for (float iou_threshold : {0.0f, 0.2f, 0.5f, 1.0f}) {
+        for (int box_idx = 0; box_idx < num_boxes; box_idx++) {
+            auto box = frame_boxes.index({Slice(box_idx, box_idx + 1)});
+            auto box_area = areas.index({Slice(box_idx, box_idx + 1)});
+            torch::Tensor ious = calculate_iou_given_area(frame_boxes, box, areas, box_area);
+            auto ious_acc = ious.accessor<float, 2>();
+
+            std::vector<int> expected_overlapping;
+            for (int i = 0; i < num_boxes; i++) {
+                if (ious_acc[i][0] >= iou_threshold) {
+                    expected_overlapping.push_back(i);
+                }
+            }
+
+            std::vector<int> overlapping;
+            find_overlapping_boxes_dense(boxes_soa, box_idx, 0, iou_threshold, overlapping);
+            ASSERT_EQ(overlapping, expected_overlapping);
+        }
+    }
+}
+
+TEST(find_overlapping_boxes_indexed, matches_dense) {
+    int num_boxes = 300;
+    std::vector<float> box_values;
+    for (int i = 0; i < num_boxes; i++) {
+        float x1 = (i * 37) % 101;
+        float y1 = (i * 11) % 53;
+        float size = 2 + i % 9;
+        box_values.insert(box_values.end(), {x1, y1, x1 + size, y1 + size});
+    }
+    auto boxes = torch::tensor(box_values, {torch::kFloat32});
+    boxes = boxes.view({1, num_boxes, 4});
+
+    boxes_soa_t boxes_soa = to_boxes_soa(boxes);
+    ASSERT_EQ(boxes_soa.indexed_frames, std::vector<uint8_t>({num_boxes >= SPATIAL_INDEX_MIN_BOXES}));
+    build_spatial_index(boxes_soa, 0);
+    ASSERT_EQ(boxes_soa.indexed_frames, std::vector<uint8_t>({1}));
+
+    for (float iou_threshold : {0.01f, 0.2f, 0.5f, 1.0f}) {
+        for (int box_idx = 0; box_idx < num_boxes; box_idx++) {
+            std::vector<int> expected_overlapping;
+            find_overlapping_boxes_dense(boxes_soa, box_idx, 0, iou_threshold, expected_overlapping);
+
+            std::vector<int> overlapping;
+            find_overlapping_boxes_indexed(boxes_soa, box_idx, 0, iou_threshold, overlapping);
+            ASSERT_EQ(overlapping, expected_overlapping);
+        }
+    }
+}
+
+TEST(get_frame_overlaps, matches_find_overlapping_boxes) {
+    // frames of 300, 0 and 40 boxes, so both an indexed and a dense frame
+    std::vector<int> frame_offsets = {0, 300, 300, 340};
+    auto boxes = torch::empty({frame_offsets.back(), 4}, torch::kFloat32);
+    auto boxes_acc = boxes.accessor<float, 2>();
+    for (int i = 0; i < frame_offsets.back(); i++) {
+        float x1 = (i * 37) % 101;
+        float y1 = (i * 11) % 53;
+        float size = 2 + i % 9;
+        boxes_acc[i][0] = x1;
+        boxes_acc[i][1] = y1;
+        boxes_acc[i][2] = x1 + size;
+        boxes_acc[i][3] = y1 + size;
+    }
+    boxes_soa_t boxes_soa = to_boxes_soa(boxes, frame_offsets);
+
+    overlap_index_t overlaps;
+    for (float iou_threshold : {0.5f, 0.2f}) {
+        prepare_overlap_index(boxes_soa, iou_threshold, overlaps);
+        ASSERT_EQ(overlaps.built, std::vector<uint8_t>(3, 0));
+
+        // the frames are looked up last to first, only the frames looked up so far are built
+        for (int f_idx = 2; f_idx >= 0; f_idx--) {
+            const frame_overlaps_t& frame_overlaps = get_frame_overlaps(boxes_soa, f_idx, overlaps);
+            ASSERT_EQ(overlaps.built[0], f_idx == 0 ? 1 : 0);
+
+            int num_boxes = frame_offsets[f_idx + 1] - frame_offsets[f_idx];
+            ASSERT_EQ(frame_overlaps.offsets.size(), num_boxes + 1);
+
+            for (int b_idx = 0; b_idx < num_boxes; b_idx++) {
+                std::vector<int> expected_overlapping;
+                find_overlapping_boxes(boxes_soa, frame_offsets[f_idx] + b_idx, f_idx, iou_threshold, expected_overlapping);
+
+                std::vector<int> overlapping(
+                    frame_overlaps.boxes.begin() + frame_overlaps.offsets[b_idx],
+                    frame_overlaps.boxes.begin() + frame_overlaps.offsets[b_idx + 1]);
+                ASSERT_EQ(overlapping, expected_overlapping);
+            }
+        }
+
+        // preparing the index again for the same boxes and threshold keeps the frames built
+        prepare_overlap_index(boxes_soa, iou_threshold, overlaps);
+        ASSERT_EQ(overlaps.built, std::vector<uint8_t>(3, 1));
+    }
+    EXPECT_GT(overlap_index_bytes(overlaps), 0);
+
+    clear_overlap_index(overlaps);
+    prepare_overlap_index(boxes_soa, 0.2f, overlaps);
+    EXPECT_EQ(overlaps.built, std::vector<uint8_t>(3, 0));
+    EXPECT_EQ(overlap_index_bytes(overlaps), 0);
+
+    // a clip with fewer frames only counts its own frames, not the memory kept from the frames of the first clip
+    boxes_soa_t first_frame = to_boxes_soa(boxes.narrow(0, 0, 300), {0, 300});
+    clear_overlap_index(overlaps);
+    prepare_overlap_index(first_frame, 0.2f, overlaps);
+    ASSERT_EQ(overlaps.built, std::vector<uint8_t>(1, 0));
+    EXPECT_EQ(overlap_index_bytes(overlaps), 0);
+
+    const frame_overlaps_t& frame_overlaps = get_frame_overlaps(first_frame, 0, overlaps);
+    int64_t frame_bytes = (frame_overlaps.offsets.capacity() + frame_overlaps.boxes.capacity()) * sizeof(int);
+    EXPECT_EQ(overlap_index_bytes(overlaps), frame_bytes);
+}
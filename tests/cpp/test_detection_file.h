@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "detection_file.h"
+#include "seq_nms.h"
+
+static void write_test_clips(const std::string& path, const std::vector<std::vector<int>>& clip_frame_sizes) {
+    // writes clips with the given numbers of boxes per frame, the boxes are random and of 3 classes
+    uint64_t num_frames = 0;
+    uint64_t num_boxes = 0;
+    for (const std::vector<int>& frame_sizes : clip_frame_sizes) {
+        num_frames += frame_sizes.size();
+        for (int frame_size : frame_sizes) {
+            num_boxes += frame_size;
+        }
+    }
+
+    create_detection_file(path, clip_frame_sizes.size(), num_frames, num_boxes);
+    DetectionFile file(path, true);
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> uniform(0.0, 1.0);
+
+    uint64_t f_idx = 0;
+    file.mutable_clip_offsets()[0] = 0;
+    file.mutable_frame_offsets()[0] = 0;
+    for (int c_idx = 0; c_idx < clip_frame_sizes.size(); c_idx++) {
+        for (int frame_size : clip_frame_sizes[c_idx]) {
+            file.mutable_frame_offsets()[f_idx + 1] = file.mutable_frame_offsets()[f_idx] + frame_size;
+            f_idx++;
+        }
+        file.mutable_clip_offsets()[c_idx + 1] = f_idx;
+    }
+    for (uint64_t b_idx = 0; b_idx < num_boxes; b_idx++) {
+        float x1 = 50.0 * uniform(generator);
+        float y1 = 50.0 * uniform(generator);
+        file.mutable_boxes()[4 * b_idx] = x1;
+        file.mutable_boxes()[4 * b_idx + 1] = y1;
+        file.mutable_boxes()[4 * b_idx + 2] = x1 + 50.0 * uniform(generator);
+        file.mutable_boxes()[4 * b_idx + 3] = y1 + 50.0 * uniform(generator);
+        file.mutable_scores()[b_idx] = uniform(generator);
+        file.mutable_classes()[b_idx] = static_cast<int32_t>(3 * uniform(generator));
+    }
+}
+
+TEST(detection_file, round_trip) {
+    std::string path = testing::TempDir() + "detection_file_round_trip.bin";
+    write_test_clips(path, {{2, 0, 3}, {1}});
+
+    DetectionFile file(path, false);
+    ASSERT_EQ(file.num_clips(), 2);
+    ASSERT_EQ(file.num_frames(), 4);
+    ASSERT_EQ(file.num_boxes(), 6);
+
+    std::vector<uint64_t> clip_offsets(file.clip_offsets(), file.clip_offsets() + 3);
+    std::vector<uint64_t> frame_offsets(file.frame_offsets(), file.frame_offsets() + 5);
+    ASSERT_EQ(clip_offsets, std::vector<uint64_t>({0, 3, 4}));
+    ASSERT_EQ(frame_offsets, std::vector<uint64_t>({0, 2, 2, 5, 6}));
+    for (int b_idx = 0; b_idx < 6; b_idx++) {
+        ASSERT_LE(file.boxes()[4 * b_idx], file.boxes()[4 * b_idx + 2]);
+        ASSERT_GE(file.classes()[b_idx], 0);
+    }
+
+    // the sections are aligned, so they can be read in place
+    detection_file_layout_t layout = get_detection_file_layout(file.header());
+    ASSERT_EQ(layout.boxes % DETECTION_FILE_ALIGNMENT, 0);
+    ASSERT_EQ(layout.scores % DETECTION_FILE_ALIGNMENT, 0);
+    ASSERT_THROW(file.mutable_scores(), std::logic_error);
+    std::remove(path.c_str());
+}
+
+TEST(detection_file, invalid_files) {
+    std::string path = testing::TempDir() + "detection_file_invalid.bin";
+
+    std::ofstream(path) << "not a detection file, but long enough for the header of one...................";
+    ASSERT_THROW(DetectionFile(path, false), std::invalid_argument);
+
+    // the frame offsets don't end at the number of boxes
+    create_detection_file(path, 1, 1, 2);
+    {
+        DetectionFile file(path, true);
+        file.mutable_clip_offsets()[1] = 1;
+        file.mutable_frame_offsets()[1] = 1;
+    }
+    ASSERT_THROW(DetectionFile(path, false), std::invalid_argument);
+
+    ASSERT_THROW(DetectionFile(path + ".missing", false), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(detection_file, rescore_same_as_seq_nms_packed) {
+    std::string input_path = testing::TempDir() + "detection_file_input.bin";
+    std::string output_path = testing::TempDir() + "detection_file_output.bin";
+    write_test_clips(input_path, {{20, 15, 20, 0, 20}, {}, {5, 30, 30}, {10}});
+
+    for (bool class_aware : {false, true}) {
+        seq_nms_options_t options = to_seq_nms_options(0.3, 0.2, "avg", class_aware, false, c10::nullopt, c10::nullopt);
+        rescore_detection_file(input_path, output_path, options);
+
+        DetectionFile input(input_path, false);
+        DetectionFile output(output_path, false);
+        ASSERT_EQ(output.num_boxes(), input.num_boxes());
+        ASSERT_EQ(std::memcmp(output.boxes(), input.boxes(), 4 * input.num_boxes() * sizeof(float)), 0);
+        ASSERT_EQ(std::memcmp(output.classes(), input.classes(), input.num_boxes() * sizeof(int32_t)), 0);
+
+        for (uint64_t c_idx = 0; c_idx < input.num_clips(); c_idx++) {
+            uint64_t first_frame = input.clip_offsets()[c_idx];
+            uint64_t last_frame = input.clip_offsets()[c_idx + 1];
+            int64_t first_box = input.frame_offsets()[first_frame];
+            int64_t num_boxes = input.frame_offsets()[last_frame] - first_box;
+
+            auto boxes = torch::empty({num_boxes, 4}, torch::kFloat32);
+            auto scores = torch::empty({num_boxes}, torch::kFloat32);
+            auto classes = torch::empty({num_boxes}, torch::kInt32);
+            auto frame_offsets = torch::empty({static_cast<int64_t>(last_frame - first_frame + 1)}, torch::kInt64);
+            std::memcpy(boxes.data_ptr<float>(), input.boxes() + 4 * first_box, 4 * num_boxes * sizeof(float));
+            std::memcpy(scores.data_ptr<float>(), input.scores() + first_box, num_boxes * sizeof(float));
+            std::memcpy(classes.data_ptr<int32_t>(), input.classes() + first_box, num_boxes * sizeof(int32_t));
+            for (uint64_t f_idx = first_frame; f_idx <= last_frame; f_idx++) {
+                frame_offsets.data_ptr<int64_t>()[f_idx - first_frame] = input.frame_offsets()[f_idx] - first_box;
+            }
+
+            torch::Tensor expected_scores = seq_nms_packed(
+                boxes, scores, classes, frame_offsets, 0.3, 0.2, "avg", class_aware, false, c10::nullopt, c10::nullopt);
+            ASSERT_EQ(
+                std::memcmp(expected_scores.data_ptr<float>(), output.scores() + first_box, num_boxes * sizeof(float)), 0);
+        }
+    }
+
+    // the output would be truncated before the input is read
+    seq_nms_options_t options = to_seq_nms_options(0.3, 0.2, "avg", false, false, c10::nullopt, c10::nullopt);
+    ASSERT_THROW(rescore_detection_file(input_path, input_path, options), std::invalid_argument);
+    std::remove(input_path.c_str());
+    std::remove(output_path.c_str());
+}
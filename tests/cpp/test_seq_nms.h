@@ -9,16 +9,13 @@ TEST(build_box_sequences, one_overlap) {
     auto boxes = torch::tensor({1, 2, 3, 4, 10, 10, 20, 20, 1, 2, 2, 3, 20, 20, 30, 30}, {torch::kFloat32});
     boxes = boxes.view({2, 2, 4});
 
-    auto areas = torch::tensor({4, 100, 1, 100});
-    areas = areas.view({2, 2});
-
     auto classes = torch::tensor({0, 0, 0, 0}, {torch::kInt32});
     classes = classes.view({2, 2});
 
-    auto graph_sequences = build_box_sequences(boxes, areas, classes, linkage_threshold);
-    box_seq_t expected_sequence{{{0}, {}}};
+    auto graph_sequences = build_box_sequences(to_boxes_soa(boxes), classes, linkage_threshold);
+    adjacency_list_t expected_sequence{{{0}, {}}};
 
-    ASSERT_EQ(graph_sequences, expected_sequence);
+    ASSERT_EQ(graph_sequences.to_adjacency(), expected_sequence);
 }
 
 TEST(build_box_sequences, two_overlap) {
@@ -27,16 +24,13 @@ TEST(build_box_sequences, two_overlap) {
     auto boxes = torch::tensor({1, 2, 3, 4, 10, 10, 20, 20, 1, 2, 2, 3, 1, 2, 2, 3}, {torch::kFloat32});
     boxes = boxes.view({2, 2, 4});
 
-    auto areas = torch::tensor({4, 100, 1, 1});
-    areas = areas.view({2, 2});
-
     auto classes = torch::tensor({0, 0, 0, 0}, {torch::kInt32});
     classes = classes.view({2, 2});
 
-    auto graph_sequences = build_box_sequences(boxes, areas, classes, linkage_threshold);
-    box_seq_t expected_sequence{{{0, 1}, {}}};
+    auto graph_sequences = build_box_sequences(to_boxes_soa(boxes), classes, linkage_threshold);
+    adjacency_list_t expected_sequence{{{0, 1}, {}}};
 
-    ASSERT_EQ(graph_sequences, expected_sequence);
+    ASSERT_EQ(graph_sequences.to_adjacency(), expected_sequence);
 }
 
 TEST(build_box_sequences, test_threshold_filter) {
@@ -45,16 +39,13 @@ TEST(build_box_sequences, test_threshold_filter) {
     auto boxes = torch::tensor({1, 2, 3, 4, 10, 10, 20, 20, 1, 2, 2, 3, 1, 2, 2, 3}, {torch::kFloat32});
     boxes = boxes.view({2, 2, 4});
 
-    auto areas = torch::tensor({4, 100, 1, 1});
-    areas = areas.view({2, 2});
-
     auto classes = torch::tensor({0, 0, 0, 0}, {torch::kInt32});
     classes = classes.view({2, 2});
 
-    auto graph_sequences = build_box_sequences(boxes, areas, classes, linkage_threshold);
-    box_seq_t expected_sequence{{{}, {}}};
+    auto graph_sequences = build_box_sequences(to_boxes_soa(boxes), classes, linkage_threshold);
+    adjacency_list_t expected_sequence{{{}, {}}};
 
-    ASSERT_EQ(graph_sequences, expected_sequence);
+    ASSERT_EQ(graph_sequences.to_adjacency(), expected_sequence);
 }
 
 TEST(build_box_sequences, test_class_filter) {
@@ -63,16 +54,13 @@ TEST(build_box_sequences, test_class_filter) {
     auto boxes = torch::tensor({1, 2, 3, 4, 10, 10, 20, 20, 1, 2, 2, 3, 1, 2, 2, 3}, {torch::kFloat32});
     boxes = boxes.view({2, 2, 4});
 
-    auto areas = torch::tensor({4, 100, 1, 1});
-    areas = areas.view({2, 2});
-
     auto classes = torch::tensor({0, 0, 1, 1}, {torch::kInt32});
     classes = classes.view({2, 2});
 
-    auto graph_sequences = build_box_sequences(boxes, areas, classes, linkage_threshold);
-    box_seq_t expected_sequence{{{}, {}}};
+    auto graph_sequences = build_box_sequences(to_boxes_soa(boxes), classes, linkage_threshold);
+    adjacency_list_t expected_sequence{{{}, {}}};
 
-    ASSERT_EQ(graph_sequences, expected_sequence);
+    ASSERT_EQ(graph_sequences.to_adjacency(), expected_sequence);
 }
 
 TEST(seq_nms, no_errors) {
@@ -100,7 +88,603 @@ TEST(seq_nms, no_errors) {
     float iou_threshold = 0.2;
     std::string metric = "avg";
 
-    torch::Tensor scores_update = seq_nms(boxes, scores, classes, linkage_threshold, iou_threshold, metric);
+    torch::Tensor scores_update = seq_nms(
+        boxes, scores, classes, linkage_threshold, iou_threshold, metric, false, false, c10::nullopt, c10::nullopt);
     std::vector<int64_t> expected_size = {NUM_FRAMES, 20};
     ASSERT_EQ(scores_update.sizes(), expected_size);
 }
+
+TEST(seq_nms_batched, same_as_seq_nms) {
+    torch::manual_seed(42);
+
+    int NUM_CLIPS = 3;
+    int NUM_FRAMES = 50;
+
+    auto width = 50.0 * torch::rand({NUM_CLIPS, NUM_FRAMES, 20});
+    auto height = 50.0 * torch::rand({NUM_CLIPS, NUM_FRAMES, 20});
+    auto x1 = 50.0 * torch::rand({NUM_CLIPS, NUM_FRAMES, 20});
+    auto y1 = 50.0 * torch::rand({NUM_CLIPS, NUM_FRAMES, 20});
+
+    auto boxes = torch::empty({NUM_CLIPS, NUM_FRAMES, 20, 4});
+    boxes.index({Slice(), Slice(), Slice(), 0}) = x1;
+    boxes.index({Slice(), Slice(), Slice(), 1}) = y1;
+    boxes.index({Slice(), Slice(), Slice(), 2}) = x1 + width;
+    boxes.index({Slice(), Slice(), Slice(), 3}) = y1 + height;
+
+    auto scores = torch::rand({NUM_CLIPS, NUM_FRAMES, 20});
+
+    auto classes = torch::randint(0, 10, {NUM_CLIPS, NUM_FRAMES, 20}, {torch::kInt32});
+    classes.index_put_({1, Slice(), Slice(10, None)}, -1);
+
+    float linkage_threshold = 0.3;
+    float iou_threshold = 0.2;
+    std::string metric = "avg";
+
+    torch::Tensor scores_update = seq_nms_batched(
+        boxes, scores, classes, linkage_threshold, iou_threshold, metric, false, false, c10::nullopt, c10::nullopt);
+    std::vector<int64_t> expected_size = {NUM_CLIPS, NUM_FRAMES, 20};
+    ASSERT_EQ(scores_update.sizes(), expected_size);
+
+    for (int clip_idx = 0; clip_idx < NUM_CLIPS; clip_idx++) {
+        torch::Tensor clip_scores = seq_nms(
+            boxes[clip_idx],
+            scores[clip_idx],
+            classes[clip_idx],
+            linkage_threshold,
+            iou_threshold,
+            metric,
+            false,
+            false,
+            c10::nullopt,
+            c10::nullopt);
+        ASSERT_TRUE(torch::equal(scores_update[clip_idx], clip_scores));
+    }
+}
+
+TEST(seq_nms, class_aware_suppression) {
+    // two overlapping sequences of different classes, the weaker one is only suppressed if suppression ignores classes
+    auto boxes = torch::tensor({0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10}, {torch::kFloat32});
+    boxes = boxes.view({2, 2, 4});
+    auto scores = torch::tensor({0.9, 0.6, 0.7, 0.4}, {torch::kFloat32});
+    scores = scores.view({2, 2});
+    auto classes = torch::tensor({0, 1, 0, 1}, {torch::kInt32});
+    classes = classes.view({2, 2});
+
+    torch::Tensor scores_update = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt);
+    auto expected_scores = torch::tensor({0.8, 0.6, 0.8, 0.4}, {torch::kFloat32});
+    ASSERT_TRUE(torch::allclose(scores_update, expected_scores.view({2, 2})));
+
+    scores_update = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", true, false, c10::nullopt, c10::nullopt);
+    expected_scores = torch::tensor({0.8, 0.5, 0.8, 0.5}, {torch::kFloat32});
+    ASSERT_TRUE(torch::allclose(scores_update, expected_scores.view({2, 2})));
+}
+
+TEST(seq_nms, linkage_threshold_rounded_to_float) {
+    // the boxes have a float IOU of 0.7f, which is below the double 0.7 but equal to it rounded to float
+    auto boxes = torch::tensor({0, 0, 10, 10, 0, 0, 7, 10}, {torch::kFloat32});
+    boxes = boxes.view({2, 1, 4});
+    auto scores = torch::tensor({0.9, 0.5}, {torch::kFloat32});
+    scores = scores.view({2, 1});
+    auto classes = torch::tensor({0, 0}, {torch::kInt32});
+    classes = classes.view({2, 1});
+
+    // build_box_sequences compares against the double threshold
+    auto graph_sequences = build_box_sequences(to_boxes_soa(boxes), classes, 0.7);
+    adjacency_list_t expected_sequence{{{}}};
+    ASSERT_EQ(graph_sequences.to_adjacency(), expected_sequence);
+
+    // seq_nms has always rounded the threshold to float first, so the boxes are linked and rescored together
+    torch::Tensor scores_update = seq_nms(boxes, scores, classes, 0.7, 0.5, "avg", false, false, c10::nullopt, c10::nullopt);
+    auto expected_scores = torch::tensor({0.7, 0.7}, {torch::kFloat32});
+    ASSERT_TRUE(torch::allclose(scores_update, expected_scores.view({2, 1})));
+
+    scores_update = seq_nms(boxes, scores, classes, 0.7, 0.5, "avg", true, false, 0.0, 1);
+    ASSERT_TRUE(torch::allclose(scores_update, expected_scores.view({2, 1})));
+}
+
+TEST(seq_nms, pruned_boxes_keep_scores) {
+    // the weaker class 1 sequence is pruned in its second frame, so it is too short to be rescored
+    auto boxes = torch::tensor({0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10}, {torch::kFloat32});
+    boxes = boxes.view({2, 2, 4});
+    auto scores = torch::tensor({0.9, 0.6, 0.7, 0.4}, {torch::kFloat32});
+    scores = scores.view({2, 2});
+    auto classes = torch::tensor({0, 1, 0, 1}, {torch::kInt32});
+    classes = classes.view({2, 2});
+    auto expected_scores = torch::tensor({0.8, 0.6, 0.8, 0.4}, {torch::kFloat32});
+
+    torch::Tensor scores_update = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", true, false, 0.5, c10::nullopt);
+    ASSERT_TRUE(torch::allclose(scores_update, expected_scores.view({2, 2})));
+
+    scores_update = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", true, false, c10::nullopt, 1);
+    ASSERT_TRUE(torch::allclose(scores_update, expected_scores.view({2, 2})));
+
+    scores_update = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", true, false, 0.0, 2);
+    torch::Tensor expected_update = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", true, false, c10::nullopt, c10::nullopt);
+    ASSERT_TRUE(torch::equal(scores_update, expected_update));
+}
+
+TEST(seq_nms, other_dtypes) {
+    auto boxes = torch::tensor({0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10}, {torch::kFloat32});
+    boxes = boxes.view({2, 2, 4});
+    auto scores = torch::tensor({0.9, 0.6, 0.7, 0.4}, {torch::kFloat32});
+    scores = scores.view({2, 2});
+    auto classes = torch::tensor({0, 1, 0, 1}, {torch::kInt32});
+    classes = classes.view({2, 2});
+
+    torch::Tensor expected_scores = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", true, false, c10::nullopt, c10::nullopt);
+
+    // the boxes are exact in every type and the scores are rescored in float32, so only the returned type changes
+    for (auto boxes_type : {torch::kFloat16, torch::kBFloat16, torch::kFloat64}) {
+        torch::Tensor scores_update = seq_nms(
+            boxes.to(boxes_type),
+            scores.to(torch::kFloat64),
+            classes.to(torch::kInt64),
+            0.5,
+            0.5,
+            "avg",
+            true,
+            false,
+            c10::nullopt,
+            c10::nullopt);
+        ASSERT_EQ(scores_update.scalar_type(), torch::kFloat64);
+        ASSERT_TRUE(torch::equal(scores_update, expected_scores.to(torch::kFloat64)));
+    }
+}
+
+TEST(seq_nms, disjoint_sequences_independent_objects) {
+    // objects on a grid which move slightly between frames, so every object is one sequence and no sequences overlap
+    torch::manual_seed(42);
+
+    int NUM_FRAMES = 10;
+    int GRID_SIZE = 4;
+
+    auto boxes = torch::empty({NUM_FRAMES, GRID_SIZE * GRID_SIZE, 4});
+    auto boxes_acc = boxes.accessor<float, 3>();
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        for (int b_idx = 0; b_idx < GRID_SIZE * GRID_SIZE; b_idx++) {
+            float x1 = 100.0 * (b_idx % GRID_SIZE) + f_idx;
+            float y1 = 100.0 * (b_idx / GRID_SIZE) + f_idx;
+            boxes_acc[f_idx][b_idx][0] = x1;
+            boxes_acc[f_idx][b_idx][1] = y1;
+            boxes_acc[f_idx][b_idx][2] = x1 + 20.0;
+            boxes_acc[f_idx][b_idx][3] = y1 + 20.0;
+        }
+    }
+
+    auto scores = torch::rand({NUM_FRAMES, GRID_SIZE * GRID_SIZE});
+    auto classes = torch::zeros({NUM_FRAMES, GRID_SIZE * GRID_SIZE}, {torch::kInt32});
+
+    for (std::string metric : {"avg", "max"}) {
+        torch::Tensor expected_scores = seq_nms(
+            boxes, scores, classes, 0.5, 0.5, metric, false, false, c10::nullopt, c10::nullopt);
+        torch::Tensor scores_update = seq_nms(
+            boxes, scores, classes, 0.5, 0.5, metric, false, true, c10::nullopt, c10::nullopt);
+        ASSERT_TRUE(torch::equal(scores_update, expected_scores));
+        ASSERT_FALSE(torch::equal(scores_update, scores));
+    }
+}
+
+TEST(seq_nms_out, same_as_seq_nms) {
+    auto boxes = torch::tensor({0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10}, {torch::kFloat32});
+    boxes = boxes.view({2, 2, 4});
+    auto scores = torch::tensor({0.9, 0.6, 0.7, 0.4}, {torch::kFloat32});
+    scores = scores.view({2, 2});
+    auto classes = torch::tensor({0, 1, 0, 1}, {torch::kInt32});
+    classes = classes.view({2, 2});
+
+    // the out tensor is resized to the shape of the scores
+    auto out = torch::empty({0}, torch::kFloat32);
+    torch::Tensor& result =
+        seq_nms_out(boxes, scores, classes, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt, out);
+    torch::Tensor expected_scores = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt);
+    ASSERT_EQ(&result, &out);
+    ASSERT_TRUE(torch::equal(out, expected_scores));
+}
+
+TEST(seq_nms_sweep, same_as_seq_nms) {
+    // random boxes, dense enough that the configurations suppress different boxes
+    torch::manual_seed(42);
+    auto boxes = torch::rand({10, 30, 4});
+    auto boxes_acc = boxes.accessor<float, 3>();
+    for (int f_idx = 0; f_idx < 10; f_idx++) {
+        for (int b_idx = 0; b_idx < 30; b_idx++) {
+            boxes_acc[f_idx][b_idx][0] *= 50.0;
+            boxes_acc[f_idx][b_idx][1] *= 50.0;
+            boxes_acc[f_idx][b_idx][2] = boxes_acc[f_idx][b_idx][0] + 10.0 + 40.0 * boxes_acc[f_idx][b_idx][2];
+            boxes_acc[f_idx][b_idx][3] = boxes_acc[f_idx][b_idx][1] + 10.0 + 40.0 * boxes_acc[f_idx][b_idx][3];
+        }
+    }
+    auto scores = torch::rand({10, 30});
+    auto classes = torch::randint(0, 3, {10, 30}, {torch::kInt32});
+
+    std::vector<double> iou_thresholds = {0.2, 0.5, 0.5, 0.0};
+    std::vector<std::string> metrics = {"avg", "avg", "max", "avg"};
+    std::vector<int64_t> expected_size = {4, 10, 30};
+    for (bool class_aware : {false, true}) {
+        for (c10::optional<int64_t> max_boxes_per_frame : {c10::optional<int64_t>(), c10::optional<int64_t>(12)}) {
+            torch::Tensor updated_scores = seq_nms_sweep(
+                boxes, scores, classes, 0.3, iou_thresholds, metrics, class_aware, false, c10::nullopt, max_boxes_per_frame);
+            ASSERT_EQ(updated_scores.sizes(), expected_size);
+
+            for (int c_idx = 0; c_idx < iou_thresholds.size(); c_idx++) {
+                torch::Tensor expected_scores = seq_nms(
+                    boxes,
+                    scores,
+                    classes,
+                    0.3,
+                    iou_thresholds[c_idx],
+                    metrics[c_idx],
+                    class_aware,
+                    false,
+                    c10::nullopt,
+                    max_boxes_per_frame);
+                ASSERT_TRUE(torch::equal(updated_scores[c_idx], expected_scores));
+            }
+        }
+    }
+
+    ASSERT_THROW(
+        seq_nms_sweep(boxes, scores, classes, 0.3, {0.5}, {"avg", "max"}, false, false, c10::nullopt, c10::nullopt),
+        std::invalid_argument);
+}
+
+TEST(seq_nms_async, same_as_seq_nms) {
+    // several clips in flight at once, every future completes with the scores of its own clip
+    torch::manual_seed(42);
+    std::vector<torch::Tensor> clip_boxes;
+    std::vector<torch::Tensor> clip_scores;
+    std::vector<torch::Tensor> clip_classes;
+    for (int clip_idx = 0; clip_idx < 6; clip_idx++) {
+        auto boxes = torch::rand({8, 20, 4});
+        auto boxes_acc = boxes.accessor<float, 3>();
+        for (int f_idx = 0; f_idx < 8; f_idx++) {
+            for (int b_idx = 0; b_idx < 20; b_idx++) {
+                boxes_acc[f_idx][b_idx][0] *= 50.0;
+                boxes_acc[f_idx][b_idx][1] *= 50.0;
+                boxes_acc[f_idx][b_idx][2] = boxes_acc[f_idx][b_idx][0] + 10.0 + 40.0 * boxes_acc[f_idx][b_idx][2];
+                boxes_acc[f_idx][b_idx][3] = boxes_acc[f_idx][b_idx][1] + 10.0 + 40.0 * boxes_acc[f_idx][b_idx][3];
+            }
+        }
+        clip_boxes.push_back(boxes);
+        clip_scores.push_back(torch::rand({8, 20}));
+        clip_classes.push_back(torch::randint(0, 3, {8, 20}, {torch::kInt32}));
+    }
+
+    std::vector<c10::intrusive_ptr<c10::ivalue::Future>> futures;
+    for (int clip_idx = 0; clip_idx < 6; clip_idx++) {
+        futures.push_back(seq_nms_async(
+            clip_boxes[clip_idx],
+            clip_scores[clip_idx],
+            clip_classes[clip_idx],
+            0.3,
+            0.5,
+            "avg",
+            clip_idx % 2 == 1,
+            false,
+            c10::nullopt,
+            c10::nullopt));
+    }
+    for (int clip_idx = 0; clip_idx < 6; clip_idx++) {
+        futures[clip_idx]->wait();
+        ASSERT_FALSE(futures[clip_idx]->hasError());
+        torch::Tensor expected_scores = seq_nms(
+            clip_boxes[clip_idx],
+            clip_scores[clip_idx],
+            clip_classes[clip_idx],
+            0.3,
+            0.5,
+            "avg",
+            clip_idx % 2 == 1,
+            false,
+            c10::nullopt,
+            c10::nullopt);
+        ASSERT_TRUE(torch::equal(futures[clip_idx]->value().toTensor(), expected_scores));
+    }
+
+    // errors in the arguments are thrown by the call, not set on the future
+    ASSERT_THROW(
+        seq_nms_async(
+            clip_boxes[0], clip_scores[0], clip_classes[0], 0.3, 0.5, "min", false, false, c10::nullopt, c10::nullopt),
+        std::invalid_argument);
+}
+
+TEST(seq_nms_with_stats, same_as_seq_nms) {
+    // two overlapping sequences of different classes, the weaker one is suppressed by the stronger one
+    auto boxes = torch::tensor({0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10}, {torch::kFloat32});
+    boxes = boxes.view({2, 2, 4});
+    auto scores = torch::tensor({0.9, 0.6, 0.7, 0.4}, {torch::kFloat32});
+    scores = scores.view({2, 2});
+    auto classes = torch::tensor({0, 1, 0, 1}, {torch::kInt32});
+    classes = classes.view({2, 2});
+
+    auto result = seq_nms_with_stats(boxes, scores, classes, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt);
+    torch::Tensor expected_scores = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt);
+    ASSERT_TRUE(torch::equal(std::get<0>(result), expected_scores));
+
+    c10::Dict<std::string, int64_t> stats = std::get<1>(result);
+    EXPECT_EQ(stats.at("iterations"), 1);
+    EXPECT_EQ(stats.at("edges_built"), 2);
+    EXPECT_EQ(stats.at("edges_deleted"), 2);
+    // the first solve and the update after the sequence both visit the two frames
+    EXPECT_EQ(stats.at("nodes_visited"), 4 + 4);
+    EXPECT_GT(stats.at("peak_graph_bytes"), 0);
+    EXPECT_GT(stats.at("overlap_index_bytes"), 0);
+    EXPECT_GE(stats.at("buffer_growths"), 0);
+}
+
+TEST(seq_nms_with_stats, buffer_growths_independent_of_iterations) {
+    // objects on a grid which don't overlap, so every object is one sequence and the buffers of the sequences grow
+    int NUM_FRAMES = 10;
+    int GRID_SIZE = 10;
+
+    auto boxes = torch::empty({NUM_FRAMES, GRID_SIZE * GRID_SIZE, 4});
+    auto boxes_acc = boxes.accessor<float, 3>();
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        for (int b_idx = 0; b_idx < GRID_SIZE * GRID_SIZE; b_idx++) {
+            float x1 = 100.0 * (b_idx % GRID_SIZE) + f_idx;
+            float y1 = 100.0 * (b_idx / GRID_SIZE) + f_idx;
+            boxes_acc[f_idx][b_idx][0] = x1;
+            boxes_acc[f_idx][b_idx][1] = y1;
+            boxes_acc[f_idx][b_idx][2] = x1 + 20.0;
+            boxes_acc[f_idx][b_idx][3] = y1 + 20.0;
+        }
+    }
+    auto scores = torch::rand({NUM_FRAMES, GRID_SIZE * GRID_SIZE});
+    auto classes = torch::zeros({NUM_FRAMES, GRID_SIZE * GRID_SIZE}, {torch::kInt32});
+
+    // the buffers grow geometrically, not once per sequence
+    for (bool disjoint_sequences : {false, true}) {
+        auto result = seq_nms_with_stats(
+            boxes, scores, classes, 0.5, 0.5, "avg", false, disjoint_sequences, c10::nullopt, c10::nullopt);
+        c10::Dict<std::string, int64_t> stats = std::get<1>(result);
+        EXPECT_EQ(stats.at("iterations"), GRID_SIZE * GRID_SIZE);
+        EXPECT_LT(stats.at("buffer_growths"), stats.at("iterations") / 2);
+    }
+}
+
+TEST(seq_nms_with_sequences, same_as_seq_nms) {
+    // two overlapping sequences of different classes, the weaker one is suppressed by the stronger one
+    auto boxes = torch::tensor({0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10}, {torch::kFloat32});
+    boxes = boxes.view({2, 2, 4});
+    auto scores = torch::tensor({0.9, 0.6, 0.7, 0.4}, {torch::kFloat32});
+    scores = scores.view({2, 2});
+    auto classes = torch::tensor({0, 1, 0, 1}, {torch::kInt32});
+    classes = classes.view({2, 2});
+
+    for (bool class_aware : {false, true}) {
+        auto result =
+            seq_nms_with_sequences(boxes, scores, classes, 0.5, 0.5, "avg", class_aware, false, c10::nullopt, c10::nullopt);
+        torch::Tensor expected_scores =
+            seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", class_aware, false, c10::nullopt, c10::nullopt);
+        ASSERT_TRUE(torch::equal(std::get<0>(result), expected_scores));
+
+        // class aware, the sequence of class 1 is kept and numbered after the one of class 0
+        torch::Tensor expected_ids = class_aware ? torch::tensor({0, 1, 0, 1}, {torch::kInt64})
+                                                 : torch::tensor({0, -1, 0, -1}, {torch::kInt64});
+        ASSERT_TRUE(torch::equal(std::get<1>(result), expected_ids.view({2, 2})));
+
+        torch::Tensor sequence_scores = std::get<2>(result);
+        torch::Tensor sequence_lengths = std::get<3>(result);
+        ASSERT_EQ(sequence_scores.size(0), class_aware ? 2 : 1);
+        EXPECT_FLOAT_EQ(sequence_scores[0].item<float>(), 0.8);
+        EXPECT_EQ(sequence_lengths[0].item<int64_t>(), 2);
+        if (class_aware) {
+            EXPECT_FLOAT_EQ(sequence_scores[1].item<float>(), 0.5);
+            EXPECT_EQ(sequence_lengths[1].item<int64_t>(), 2);
+        }
+    }
+}
+
+TEST(seq_nms_bounded, stops_at_limits) {
+    // objects on a grid which move slightly between frames, every object is one sequence
+    torch::manual_seed(42);
+
+    int NUM_FRAMES = 10;
+    int GRID_SIZE = 3;
+
+    auto boxes = torch::empty({NUM_FRAMES, GRID_SIZE * GRID_SIZE, 4});
+    auto boxes_acc = boxes.accessor<float, 3>();
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        for (int b_idx = 0; b_idx < GRID_SIZE * GRID_SIZE; b_idx++) {
+            float x1 = 100.0 * (b_idx % GRID_SIZE) + f_idx;
+            float y1 = 100.0 * (b_idx / GRID_SIZE) + f_idx;
+            boxes_acc[f_idx][b_idx][0] = x1;
+            boxes_acc[f_idx][b_idx][1] = y1;
+            boxes_acc[f_idx][b_idx][2] = x1 + 20.0;
+            boxes_acc[f_idx][b_idx][3] = y1 + 20.0;
+        }
+    }
+
+    auto scores = torch::rand({NUM_FRAMES, GRID_SIZE * GRID_SIZE});
+    auto classes = torch::zeros({NUM_FRAMES, GRID_SIZE * GRID_SIZE}, {torch::kInt32});
+
+    auto result = seq_nms_with_sequences(boxes, scores, classes, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt);
+    torch::Tensor sequence_ids = std::get<1>(result);
+
+    // without limits, or with limits which aren't reached, seq-nms completes
+    auto bounded =
+        seq_nms_bounded(boxes, scores, classes, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt, 100, 0.0, 1e6);
+    ASSERT_TRUE(torch::equal(std::get<0>(bounded), std::get<0>(result)));
+    ASSERT_EQ(std::get<1>(bounded), "completed");
+
+    // the first sequences are the same as without a limit, the boxes of the others keep their scores
+    for (bool disjoint_sequences : {false, true}) {
+        bounded = seq_nms_bounded(
+            boxes,
+            scores,
+            classes,
+            0.5,
+            0.5,
+            "avg",
+            false,
+            disjoint_sequences,
+            c10::nullopt,
+            c10::nullopt,
+            4,
+            c10::nullopt,
+            c10::nullopt);
+        ASSERT_EQ(std::get<1>(bounded), "max_sequences");
+
+        auto bounded_acc = std::get<0>(bounded).accessor<float, 2>();
+        auto expected_acc = std::get<0>(result).accessor<float, 2>();
+        auto scores_acc = scores.accessor<float, 2>();
+        auto sequence_ids_acc = sequence_ids.accessor<int64_t, 2>();
+        for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+            for (int b_idx = 0; b_idx < GRID_SIZE * GRID_SIZE; b_idx++) {
+                bool taken = (sequence_ids_acc[f_idx][b_idx] >= 0) && (sequence_ids_acc[f_idx][b_idx] < 4);
+                ASSERT_EQ(bounded_acc[f_idx][b_idx], taken ? expected_acc[f_idx][b_idx] : scores_acc[f_idx][b_idx]);
+            }
+        }
+    }
+
+    // no sequence scores that much, and no time is left for the first one
+    bounded = seq_nms_bounded(
+        boxes,
+        scores,
+        classes,
+        0.5,
+        0.5,
+        "avg",
+        false,
+        false,
+        c10::nullopt,
+        c10::nullopt,
+        c10::nullopt,
+        1000.0,
+        c10::nullopt);
+    ASSERT_TRUE(torch::equal(std::get<0>(bounded), scores));
+    ASSERT_EQ(std::get<1>(bounded), "min_sequence_score");
+
+    bounded = seq_nms_bounded(
+        boxes, scores, classes, 0.5, 0.5, "avg", true, false, c10::nullopt, c10::nullopt, c10::nullopt, c10::nullopt, 0.0);
+    ASSERT_TRUE(torch::equal(std::get<0>(bounded), scores));
+    ASSERT_EQ(std::get<1>(bounded), "deadline");
+}
+
+TEST(seq_nms_chunked, stitched_sequences_same_as_seq_nms) {
+    // objects on a grid which move slightly between frames, every object is one sequence crossing every chunk boundary
+    torch::manual_seed(42);
+
+    int NUM_FRAMES = 12;
+    int GRID_SIZE = 3;
+
+    auto boxes = torch::empty({NUM_FRAMES, GRID_SIZE * GRID_SIZE, 4});
+    auto boxes_acc = boxes.accessor<float, 3>();
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        for (int b_idx = 0; b_idx < GRID_SIZE * GRID_SIZE; b_idx++) {
+            float x1 = 100.0 * (b_idx % GRID_SIZE) + f_idx;
+            float y1 = 100.0 * (b_idx / GRID_SIZE) + f_idx;
+            boxes_acc[f_idx][b_idx][0] = x1;
+            boxes_acc[f_idx][b_idx][1] = y1;
+            boxes_acc[f_idx][b_idx][2] = x1 + 20.0;
+            boxes_acc[f_idx][b_idx][3] = y1 + 20.0;
+        }
+    }
+
+    // every sequence of a chunk outscores a single box, so no chunk stops before the whole clip would
+    auto scores = torch::rand({NUM_FRAMES, GRID_SIZE * GRID_SIZE});
+    auto scores_acc = scores.accessor<float, 2>();
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        for (int b_idx = 0; b_idx < GRID_SIZE * GRID_SIZE; b_idx++) {
+            scores_acc[f_idx][b_idx] = 0.5 + 0.5 * scores_acc[f_idx][b_idx];
+        }
+    }
+    auto classes = torch::zeros({NUM_FRAMES, GRID_SIZE * GRID_SIZE}, {torch::kInt32});
+
+    // one chunk for the whole clip, then chunks with an odd and an even overlap
+    std::vector<std::pair<int64_t, int64_t>> chunks = {{NUM_FRAMES, 0}, {4, 2}, {5, 3}};
+    for (std::string metric : {"avg", "max"}) {
+        torch::Tensor expected_scores =
+            seq_nms(boxes, scores, classes, 0.5, 0.5, metric, false, false, c10::nullopt, c10::nullopt);
+        for (const auto& chunk : chunks) {
+            torch::Tensor scores_update = seq_nms_chunked(
+                boxes, scores, classes, 0.5, 0.5, metric, false, false, c10::nullopt, c10::nullopt, chunk.first, chunk.second);
+            ASSERT_TRUE(torch::equal(scores_update, expected_scores));
+        }
+    }
+
+    ASSERT_THROW(
+        seq_nms_chunked(boxes, scores, classes, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt, 0, 0),
+        std::invalid_argument);
+    ASSERT_THROW(
+        seq_nms_chunked(boxes, scores, classes, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt, 4, 4),
+        std::invalid_argument);
+}
+
+TEST(seq_nms_packed, same_as_seq_nms) {
+    torch::manual_seed(42);
+
+    int NUM_FRAMES = 50;
+
+    auto width = 50.0 * torch::rand({NUM_FRAMES, 20});
+    auto height = 50.0 * torch::rand({NUM_FRAMES, 20});
+    auto x1 = 50.0 * torch::rand({NUM_FRAMES, 20});
+    auto y1 = 50.0 * torch::rand({NUM_FRAMES, 20});
+
+    auto boxes = torch::empty({NUM_FRAMES, 20, 4});
+    boxes.index({Slice(), Slice(), 0}) = x1;
+    boxes.index({Slice(), Slice(), 1}) = y1;
+    boxes.index({Slice(), Slice(), 2}) = x1 + width;
+    boxes.index({Slice(), Slice(), 3}) = y1 + height;
+
+    auto scores = torch::rand({NUM_FRAMES, 20});
+
+    auto classes = torch::randint(0, 10, {NUM_FRAMES, 20}, {torch::kInt32});
+
+    // frame f has f % 20 boxes, the rest is padding
+    std::vector<torch::Tensor> packed_boxes;
+    std::vector<torch::Tensor> packed_scores;
+    std::vector<torch::Tensor> packed_classes;
+    auto frame_offsets = torch::zeros({NUM_FRAMES + 1}, {torch::kInt64});
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        int num_boxes = f_idx % 20;
+        classes.index_put_({f_idx, Slice(num_boxes, None)}, -1);
+
+        packed_boxes.push_back(boxes.index({f_idx, Slice(None, num_boxes)}));
+        packed_scores.push_back(scores.index({f_idx, Slice(None, num_boxes)}));
+        packed_classes.push_back(classes.index({f_idx, Slice(None, num_boxes)}));
+        frame_offsets.index_put_({f_idx + 1}, frame_offsets[f_idx].item<int64_t>() + num_boxes);
+    }
+
+    float linkage_threshold = 0.3;
+    float iou_threshold = 0.2;
+    std::string metric = "avg";
+
+    torch::Tensor scores_update = seq_nms_packed(
+        torch::cat(packed_boxes),
+        torch::cat(packed_scores),
+        torch::cat(packed_classes),
+        frame_offsets,
+        linkage_threshold,
+        iou_threshold,
+        metric,
+        false,
+        false,
+        c10::nullopt,
+        c10::nullopt);
+    torch::Tensor expected_scores = seq_nms(
+        boxes, scores, classes, linkage_threshold, iou_threshold, metric, false, false, c10::nullopt, c10::nullopt);
+
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        int64_t frame_offset = frame_offsets[f_idx].item<int64_t>();
+        torch::Tensor frame_scores = scores_update.index({Slice(frame_offset, frame_offset + f_idx % 20)});
+        ASSERT_TRUE(torch::equal(frame_scores, expected_scores.index({f_idx, Slice(None, f_idx % 20)})));
+    }
+}
+
+TEST(seq_nms_packed, invalid_frame_offsets) {
+    auto boxes = torch::tensor({1, 2, 3, 4, 10, 10, 20, 20}, {torch::kFloat32});
+    boxes = boxes.view({2, 4});
+    auto scores = torch::tensor({0.5, 0.7}, {torch::kFloat32});
+    auto classes = torch::tensor({0, 0}, {torch::kInt32});
+
+    auto frame_offsets = torch::tensor({0, 1}, {torch::kInt64});
+    ASSERT_THROW(
+        seq_nms_packed(boxes, scores, classes, frame_offsets, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt),
+        std::invalid_argument);
+
+    frame_offsets = torch::tensor({0, 2, 1, 2}, {torch::kInt64});
+    ASSERT_THROW(
+        seq_nms_packed(boxes, scores, classes, frame_offsets, 0.5, 0.5, "avg", false, false, c10::nullopt, c10::nullopt),
+        std::invalid_argument);
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "seq_nms.h"
+#include "seq_nms_stream.h"
+
+using namespace torch::indexing;
+
+TEST(seq_nms_stream, same_as_seq_nms) {
+    torch::manual_seed(42);
+
+    int NUM_FRAMES = 30;
+
+    auto width = 50.0 * torch::rand({NUM_FRAMES, 20});
+    auto height = 50.0 * torch::rand({NUM_FRAMES, 20});
+    auto x1 = 50.0 * torch::rand({NUM_FRAMES, 20});
+    auto y1 = 50.0 * torch::rand({NUM_FRAMES, 20});
+
+    auto boxes = torch::empty({NUM_FRAMES, 20, 4});
+    boxes.index({Slice(), Slice(), 0}) = x1;
+    boxes.index({Slice(), Slice(), 1}) = y1;
+    boxes.index({Slice(), Slice(), 2}) = x1 + width;
+    boxes.index({Slice(), Slice(), 3}) = y1 + height;
+
+    auto scores = torch::rand({NUM_FRAMES, 20});
+
+    auto classes = torch::randint(0, 10, {NUM_FRAMES, 20}, {torch::kInt32});
+
+    float linkage_threshold = 0.3;
+    float iou_threshold = 0.2;
+    std::string metric = "avg";
+
+    SeqNmsStream stream(linkage_threshold, iou_threshold, metric, NUM_FRAMES);
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        auto finalized = stream.push_frame(boxes[f_idx], scores[f_idx], classes[f_idx]);
+        ASSERT_TRUE(finalized.empty());
+    }
+    ASSERT_EQ(stream.num_pending_frames(), NUM_FRAMES);
+
+    auto finalized = stream.flush();
+    ASSERT_EQ(finalized.size(), NUM_FRAMES);
+    ASSERT_EQ(stream.num_pending_frames(), 0);
+
+    torch::Tensor expected_scores = seq_nms(
+        boxes, scores, classes, linkage_threshold, iou_threshold, metric, false, false, c10::nullopt, c10::nullopt);
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        ASSERT_TRUE(torch::equal(finalized[f_idx], expected_scores[f_idx]));
+    }
+}
+
+TEST(seq_nms_stream, lookahead) {
+    auto boxes = torch::tensor({1, 2, 3, 4, 10, 10, 20, 20}, {torch::kFloat32});
+    boxes = boxes.view({2, 4});
+    auto scores = torch::tensor({0.5, 0.7}, {torch::kFloat32});
+    auto classes = torch::tensor({0, 0}, {torch::kInt32});
+
+    int lookahead = 2;
+    SeqNmsStream stream(0.5, 0.5, "avg", lookahead);
+
+    for (int f_idx = 0; f_idx < 5; f_idx++) {
+        auto finalized = stream.push_frame(boxes, scores, classes);
+        ASSERT_EQ(finalized.size(), f_idx >= lookahead ? 1 : 0);
+        ASSERT_EQ(stream.num_pending_frames(), std::min(f_idx + 1, lookahead));
+    }
+
+    // the boxes stay in place, so the sequences link all pending frames and every box keeps its average score
+    auto finalized = stream.flush();
+    ASSERT_EQ(finalized.size(), lookahead);
+    for (const auto& frame_scores : finalized) {
+        ASSERT_TRUE(torch::equal(frame_scores, scores));
+    }
+}
+
+TEST(seq_nms_stream, sliding_window_same_as_seq_nms) {
+    // the graph and best paths are kept while the window slides, every finalized frame is rescored the same as seq_nms
+    // on the frames pending when it was finalized
+    torch::manual_seed(42);
+
+    int NUM_FRAMES = 30;
+    auto boxes = torch::rand({NUM_FRAMES, 20, 4});
+    auto boxes_acc = boxes.accessor<float, 3>();
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        for (int b_idx = 0; b_idx < 20; b_idx++) {
+            boxes_acc[f_idx][b_idx][0] *= 50.0;
+            boxes_acc[f_idx][b_idx][1] *= 50.0;
+            boxes_acc[f_idx][b_idx][2] = boxes_acc[f_idx][b_idx][0] + 50.0 * boxes_acc[f_idx][b_idx][2];
+            boxes_acc[f_idx][b_idx][3] = boxes_acc[f_idx][b_idx][1] + 50.0 * boxes_acc[f_idx][b_idx][3];
+        }
+    }
+    auto scores = torch::rand({NUM_FRAMES, 20});
+    auto classes = torch::randint(0, 3, {NUM_FRAMES, 20}, {torch::kInt32});
+
+    int lookahead = 5;
+    SeqNmsStream stream(0.3, 0.2, "avg", lookahead);
+    for (int f_idx = 0; f_idx < NUM_FRAMES; f_idx++) {
+        auto finalized = stream.push_frame(boxes[f_idx], scores[f_idx], classes[f_idx]);
+        if (f_idx < lookahead) {
+            ASSERT_TRUE(finalized.empty());
+            continue;
+        }
+
+        int first_frame = f_idx - lookahead;
+        torch::Tensor expected_scores = seq_nms(
+            boxes.narrow(0, first_frame, lookahead + 1),
+            scores.narrow(0, first_frame, lookahead + 1),
+            classes.narrow(0, first_frame, lookahead + 1),
+            0.3,
+            0.2,
+            "avg",
+            false,
+            false,
+            c10::nullopt,
+            c10::nullopt);
+        ASSERT_EQ(finalized.size(), 1);
+        ASSERT_TRUE(torch::equal(finalized[0], expected_scores[0]));
+    }
+
+    auto finalized = stream.flush();
+    torch::Tensor expected_scores = seq_nms(
+        boxes.narrow(0, NUM_FRAMES - lookahead, lookahead),
+        scores.narrow(0, NUM_FRAMES - lookahead, lookahead),
+        classes.narrow(0, NUM_FRAMES - lookahead, lookahead),
+        0.3,
+        0.2,
+        "avg",
+        false,
+        false,
+        c10::nullopt,
+        c10::nullopt);
+    ASSERT_EQ(finalized.size(), lookahead);
+    for (int f_idx = 0; f_idx < lookahead; f_idx++) {
+        ASSERT_TRUE(torch::equal(finalized[f_idx], expected_scores[f_idx]));
+    }
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "seq_nms.h"
+#include "seq_nms_workspace.h"
+
+using namespace torch::indexing;
+
+TEST(seq_nms_workspace, same_as_seq_nms) {
+    torch::manual_seed(42);
+
+    auto workspace = c10::make_intrusive<SeqNmsWorkspace>();
+
+    // clips of different sizes and options share the workspace
+    for (int NUM_FRAMES : {30, 10, 50}) {
+        for (bool class_aware : {false, true}) {
+            auto width = 50.0 * torch::rand({NUM_FRAMES, 20});
+            auto height = 50.0 * torch::rand({NUM_FRAMES, 20});
+            auto x1 = 50.0 * torch::rand({NUM_FRAMES, 20});
+            auto y1 = 50.0 * torch::rand({NUM_FRAMES, 20});
+
+            auto boxes = torch::empty({NUM_FRAMES, 20, 4});
+            boxes.index({Slice(), Slice(), 0}) = x1;
+            boxes.index({Slice(), Slice(), 1}) = y1;
+            boxes.index({Slice(), Slice(), 2}) = x1 + width;
+            boxes.index({Slice(), Slice(), 3}) = y1 + height;
+
+            auto scores = torch::rand({NUM_FRAMES, 20});
+
+            auto classes = torch::randint(0, 10, {NUM_FRAMES, 20}, {torch::kInt32});
+
+            torch::Tensor expected_scores =
+                seq_nms(boxes, scores, classes, 0.3, 0.2, "avg", class_aware, false, c10::nullopt, c10::nullopt);
+
+            torch::Tensor updated_scores = scores.clone();
+            torch::Tensor returned_scores = seq_nms_(
+                boxes, updated_scores, classes, 0.3, 0.2, "avg", class_aware, false, c10::nullopt, c10::nullopt, workspace);
+
+            ASSERT_TRUE(torch::equal(updated_scores, expected_scores));
+            ASSERT_EQ(returned_scores.data_ptr(), updated_scores.data_ptr());
+        }
+    }
+}
+
+TEST(seq_nms_workspace, reused_memory) {
+    auto boxes = torch::tensor({0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10}, {torch::kFloat32});
+    boxes = boxes.view({2, 2, 4});
+    auto scores = torch::tensor({0.9, 0.6, 0.7, 0.4}, {torch::kFloat32});
+    scores = scores.view({2, 2});
+    auto classes = torch::tensor({0, 1, 0, 1}, {torch::kInt32});
+    classes = classes.view({2, 2});
+
+    auto workspace = c10::make_intrusive<SeqNmsWorkspace>();
+    int64_t empty_bytes = workspace->num_bytes();
+
+    torch::Tensor updated_scores = scores.clone();
+    seq_nms_(boxes, updated_scores, classes, 0.5, 0.5, "avg", true, false, c10::nullopt, c10::nullopt, workspace);
+    int64_t num_bytes = workspace->num_bytes();
+    ASSERT_GT(num_bytes, empty_bytes);
+
+    // the second call fits in the memory of the first one
+    torch::Tensor second_scores = scores.clone();
+    seq_nms_(boxes, second_scores, classes, 0.5, 0.5, "avg", true, false, c10::nullopt, c10::nullopt, workspace);
+    ASSERT_EQ(workspace->num_bytes(), num_bytes);
+    ASSERT_TRUE(torch::equal(second_scores, updated_scores));
+
+    workspace->clear();
+    ASSERT_EQ(workspace->num_bytes(), empty_bytes);
+}
+
+TEST(seq_nms_workspace, other_dtypes) {
+    auto boxes = torch::tensor({0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10, 0, 0, 10, 10}, {torch::kFloat32});
+    boxes = boxes.view({2, 2, 4});
+    auto scores = torch::tensor({0.9, 0.6, 0.7, 0.4}, {torch::kFloat32});
+    scores = scores.view({2, 2});
+    auto classes = torch::tensor({0, 1, 0, 1}, {torch::kInt32});
+    classes = classes.view({2, 2});
+
+    torch::Tensor expected_scores = seq_nms(boxes, scores, classes, 0.5, 0.5, "avg", true, false, c10::nullopt, c10::nullopt);
+
+    // the scores can't be rescored in place and go through the float32 copy of the workspace
+    torch::Tensor updated_scores = scores.to(torch::kFloat64);
+    seq_nms_(boxes, updated_scores, classes, 0.5, 0.5, "avg", true, false, c10::nullopt, c10::nullopt, c10::nullopt);
+    ASSERT_EQ(updated_scores.scalar_type(), torch::kFloat64);
+    ASSERT_TRUE(torch::equal(updated_scores, expected_scores.to(torch::kFloat64)));
+}
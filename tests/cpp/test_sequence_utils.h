@@ -2,25 +2,32 @@
 #include "sequence_utils.h"
 
 TEST(find_highest_score_sequence, find_highest) {
-    std::vector<score_indicies_list> sequences = {
-        {std::make_tuple(0.3, std::vector<int>{3, 2}), std::make_tuple(0.2, std::vector<int>{4, 3})},
-        {std::make_tuple(0.4, std::vector<int>{2, 1}), std::make_tuple(0.5, std::vector<int>{1, 0})},
-        {}};
+    std::vector<std::tuple<float, int>> frame_best_roots = {
+        std::make_tuple(0.3, 3), std::make_tuple(0.5, 1), std::make_tuple(0.0, -1), std::make_tuple(0.5, 0)};
 
-    auto best_tuple = find_highest_score_sequence(sequences);
+    auto best_tuple = find_highest_score_sequence(frame_best_roots);
 
     int expected_index = 1;
-    EXPECT_FLOAT_EQ(std::get<0>(best_tuple), expected_index);
+    EXPECT_EQ(std::get<0>(best_tuple), expected_index);
 
-    std::vector<int> expected_indicies = {0, 1};
-    EXPECT_EQ(std::get<1>(best_tuple), expected_indicies);
+    int expected_box = 1;
+    EXPECT_EQ(std::get<1>(best_tuple), expected_box);
 
     float expected_score = 0.5;
     EXPECT_FLOAT_EQ(std::get<2>(best_tuple), expected_score);
 }
 
+TEST(find_highest_score_sequence, no_positive_score) {
+    std::vector<std::tuple<float, int>> frame_best_roots = {std::make_tuple(0.0, 0), std::make_tuple(0.0, -1)};
+
+    auto best_tuple = find_highest_score_sequence(frame_best_roots);
+
+    int expected_box = -1;
+    EXPECT_EQ(std::get<1>(best_tuple), expected_box);
+}
+
 TEST(find_best_sequence, full_length) {
-    box_seq_t box_sequence = {{{0, 1}, {}}, {{0}, {}}};
+    BoxGraph box_sequence({{{0, 1}, {}}, {{0}, {}}}, 2);
     auto scores = torch::tensor({0.1, 0.15, 0.2, 0.05, 0.07, 0.08}, {torch::kFloat32});
     scores = scores.view({3, 2});
 
@@ -34,7 +41,7 @@ TEST(find_best_sequence, full_length) {
 }
 
 TEST(find_best_sequence, subset) {
-    box_seq_t box_sequence = {{{0, 1}, {}}, {{}, {}}};
+    BoxGraph box_sequence({{{0, 1}, {}}, {{}, {}}}, 2);
     auto scores = torch::tensor({0.1, 0.15, 0.05, 0.2, 0.07, 0.08}, {torch::kFloat32});
     scores = scores.view({3, 2});
 
@@ -48,7 +55,7 @@ TEST(find_best_sequence, subset) {
 }
 
 TEST(find_best_sequence, empty) {
-    box_seq_t box_sequence = {{{}, {}}, {{}, {}}};
+    BoxGraph box_sequence({{{}, {}}, {{}, {}}}, 2);
     auto scores = torch::tensor({0.1, 0.15, 0.05, 0.2, 0.07, 0.08}, {torch::kFloat32});
     scores = scores.view({3, 2});
 
@@ -61,6 +68,98 @@ TEST(find_best_sequence, empty) {
     EXPECT_FLOAT_EQ(std::get<2>(best_tuple), expected_score);
 }
 
+TEST(find_best_sequence, from_state) {
+    BoxGraph box_sequence({{{0, 1}, {}}, {{0}, {}}}, 2);
+    auto scores = torch::tensor({0.1, 0.15, 0.2, 0.05, 0.07, 0.08}, {torch::kFloat32});
+    scores = scores.view({3, 2});
+
+    auto state = init_sequence_state(box_sequence, scores);
+    auto best_tuple = find_best_sequence(box_sequence, state);
+
+    int expected_index = 0;
+    EXPECT_EQ(std::get<0>(best_tuple), expected_index);
+
+    std::vector<int> expected_indicies = {0, 0, 0};
+    EXPECT_EQ(std::get<1>(best_tuple), expected_indicies);
+
+    float expected_score = 0.37;
+    EXPECT_FLOAT_EQ(std::get<2>(best_tuple), expected_score);
+}
+
+TEST(update_sequence_state, matches_full_solve) {
+    BoxGraph box_sequence({{{0, 1}, {1}}, {{0}, {0, 1}}, {{1}, {0}}}, 2);
+    auto scores = torch::tensor({0.1, 0.15, 0.2, 0.05, 0.07, 0.08, 0.3, 0.01}, {torch::kFloat32});
+    scores = scores.view({4, 2});
+
+    auto state = init_sequence_state(box_sequence, scores);
+
+    // remove box 0 in frame 2 from the graph, as delete_sequence would
+    box_sequence.remove_box(2, 0);
+    update_sequence_state(box_sequence, scores, state, 1, 2);
+
+    auto expected_tuple = find_best_sequence(box_sequence, scores);
+    auto best_tuple = find_best_sequence(box_sequence, state);
+
+    EXPECT_EQ(std::get<0>(best_tuple), std::get<0>(expected_tuple));
+    EXPECT_EQ(std::get<1>(best_tuple), std::get<1>(expected_tuple));
+    EXPECT_EQ(std::get<2>(best_tuple), std::get<2>(expected_tuple));
+}
+
+TEST(init_sequence_state, wide_frames) {
+    // frames wide enough to be relaxed in parallel, scores repeat so that the best paths have ties
+    int num_frames = 3;
+    int num_boxes = 3000;
+    adjacency_list_t adjacency_list(num_frames - 1, std::vector<std::vector<int>>(num_boxes));
+    for (int f_idx = 0; f_idx < num_frames - 1; f_idx++) {
+        for (int b_idx = 0; b_idx < num_boxes; b_idx++) {
+            if ((b_idx % 7 != 0) && (b_idx + 1 < num_boxes)) {
+                adjacency_list[f_idx][b_idx] = {b_idx, b_idx + 1};
+            }
+        }
+    }
+    BoxGraph box_sequence(adjacency_list, num_boxes);
+    auto scores = torch::empty({num_frames, num_boxes}, torch::kFloat32);
+    auto scores_acc = scores.accessor<float, 2>();
+    for (int f_idx = 0; f_idx < num_frames; f_idx++) {
+        for (int b_idx = 0; b_idx < num_boxes; b_idx++) {
+            scores_acc[f_idx][b_idx] = static_cast<float>(b_idx % 10) / 10;
+        }
+    }
+
+    auto state = init_sequence_state(box_sequence, scores);
+
+    // the same DP, solved sequentially
+    std::vector<float> expected_scores(num_frames * num_boxes);
+    std::vector<int> expected_predecessors(num_frames * num_boxes, -1);
+    std::vector<uint8_t> expected_has_incoming(num_frames * num_boxes, 0);
+    for (int f_idx = num_frames - 1; f_idx >= 0; f_idx--) {
+        for (int b_idx = 0; b_idx < num_boxes; b_idx++) {
+            int node_idx = f_idx * num_boxes + b_idx;
+            expected_scores[node_idx] = scores_acc[f_idx][b_idx];
+            if (f_idx == num_frames - 1) {
+                continue;
+            }
+
+            const float* next_scores = expected_scores.data() + (f_idx + 1) * num_boxes;
+            int predecessor = -1;
+            for (int e_idx : adjacency_list[f_idx][b_idx]) {
+                expected_has_incoming[(f_idx + 1) * num_boxes + e_idx] = 1;
+                if ((predecessor < 0) || (next_scores[e_idx] > next_scores[predecessor])) {
+                    predecessor = e_idx;
+                }
+            }
+            if (predecessor >= 0) {
+                expected_scores[node_idx] = expected_scores[node_idx] + next_scores[predecessor];
+            }
+            expected_predecessors[node_idx] = predecessor;
+        }
+    }
+
+    EXPECT_EQ(state.path_scores, expected_scores);
+    EXPECT_EQ(state.predecessors, expected_predecessors);
+    EXPECT_EQ(state.has_incoming, expected_has_incoming);
+}
+
 TEST(rescore_sequence, avg) {
     auto scores = torch::tensor({0.1, 0.15, 0.05, 0.2, 0.07, 0.08}, {torch::kFloat32});
     scores = scores.view({3, 2});
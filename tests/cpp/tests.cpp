@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
+#include "test_box_graph.h"
 #include "test_box_utils.h"
+#include "test_detection_file.h"
 #include "test_seq_nms.h"
+#include "test_seq_nms_stream.h"
+#include "test_seq_nms_workspace.h"
 #include "test_sequence_utils.h"
 
 int main(int argc, char** argv) {
@@ -6,7 +6,7 @@ from typing import List
 
 import torch
 
-from pt_seq_nms.seq_nms import seq_nms, seq_nms_from_list
+from pt_seq_nms.seq_nms import seq_nms, seq_nms_async, seq_nms_from_list
 
 
 def _save_load_module(jit_module):
@@ -27,6 +27,37 @@ class TestSeqNMSListModule(torch.nn.Module):
         return seq_nms_from_list(boxes, scores, classes, 0.2, 0.2)
 
 
+class TestSeqNMSStreamModule(torch.nn.Module):
+    def forward(self, boxes: List[torch.Tensor], scores: List[torch.Tensor], classes: List[torch.Tensor]) -> List[torch.Tensor]:
+        stream = torch.classes.seq_nms.SeqNmsStream(0.2, 0.2, "avg", 1)
+
+        finalized: List[torch.Tensor] = []
+        for frame_idx in range(len(boxes)):
+            finalized += stream.push_frame(boxes[frame_idx], scores[frame_idx], classes[frame_idx])
+        finalized += stream.flush()
+        return finalized
+
+
+class TestSeqNMSWorkspaceModule(torch.nn.Module):
+    def forward(self, boxes: torch.Tensor, scores: torch.Tensor, classes: torch.Tensor) -> torch.Tensor:
+        workspace = torch.classes.seq_nms.SeqNmsWorkspace()
+
+        updated_scores = scores.clone()
+        for _ in range(2):
+            updated_scores.copy_(scores)
+            torch.ops.seq_nms.seq_nms_(boxes, updated_scores, classes, 0.2, 0.2, "avg", False, False, None, None, workspace)
+        return updated_scores
+
+
+class TestSeqNMSAsyncModule(torch.nn.Module):
+    def forward(self, boxes: List[torch.Tensor], scores: List[torch.Tensor], classes: List[torch.Tensor]) -> List[torch.Tensor]:
+        # every clip is rescored while the next one is submitted
+        futures: List[torch.jit.Future[torch.Tensor]] = []
+        for clip_idx in range(len(boxes)):
+            futures.append(seq_nms_async(boxes[clip_idx], scores[clip_idx], classes[clip_idx], 0.2, 0.2))
+        return [torch.jit.wait(future) for future in futures]
+
+
 class TestSeqNMSScriptable(unittest.TestCase):
     def setUp(self):
         self.module = TestSeqNMSModule()
@@ -141,5 +172,67 @@ class TestSeqNMSListTracing(unittest.TestCase):
         _ = loaded_module(boxes, scores, classes)
 
 
+class TestSeqNMSStreamScriptable(unittest.TestCase):
+    def setUp(self):
+        self.module = TestSeqNMSStreamModule()
+        torch.random.manual_seed(42)
+        self.boxes = [100 * torch.rand((2, 4)).float().cpu() for _ in range(3)]
+        self.scores = [torch.rand((2,)).float().cpu() for _ in range(3)]
+        self.classes = [torch.randint(0, 10, (2,)).int().cpu() for _ in range(3)]
+
+    def _call_module(self, module):
+        finalized = module(self.boxes, self.scores, self.classes)
+        self.assertEqual(len(finalized), len(self.boxes))
+
+    def test_scriptable_cpu(self):
+        jit_module = torch.jit.script(deepcopy(self.module))
+        self._call_module(jit_module)
+
+        loaded_module = _save_load_module(jit_module)
+        self._call_module(loaded_module)
+
+
+class TestSeqNMSWorkspaceScriptable(unittest.TestCase):
+    def setUp(self):
+        self.module = TestSeqNMSWorkspaceModule()
+        torch.random.manual_seed(42)
+        self.boxes = 100 * torch.rand((10, 2, 4)).float().cpu()
+        self.scores = torch.rand((10, 2)).float().cpu()
+        self.classes = torch.randint(0, 10, (10, 2)).int().cpu()
+
+    def _call_module(self, module):
+        updated_scores = module(self.boxes, self.scores, self.classes)
+        self.assertEqual(updated_scores.shape, self.scores.shape)
+
+    def test_scriptable_cpu(self):
+        jit_module = torch.jit.script(deepcopy(self.module))
+        self._call_module(jit_module)
+
+        loaded_module = _save_load_module(jit_module)
+        self._call_module(loaded_module)
+
+
+class TestSeqNMSAsyncScriptable(unittest.TestCase):
+    def setUp(self):
+        self.module = TestSeqNMSAsyncModule()
+        torch.random.manual_seed(42)
+        self.boxes = [100 * torch.rand((10, 2, 4)).float().cpu() for _ in range(3)]
+        self.scores = [torch.rand((10, 2)).float().cpu() for _ in range(3)]
+        self.classes = [torch.randint(0, 10, (10, 2)).int().cpu() for _ in range(3)]
+
+    def _call_module(self, module):
+        updated_scores = module(self.boxes, self.scores, self.classes)
+        for clip_idx in range(len(self.boxes)):
+            expected_scores = seq_nms(self.boxes[clip_idx], self.scores[clip_idx], self.classes[clip_idx], 0.2, 0.2)
+            self.assertTrue(torch.equal(updated_scores[clip_idx], expected_scores))
+
+    def test_scriptable_cpu(self):
+        jit_module = torch.jit.script(deepcopy(self.module))
+        self._call_module(jit_module)
+
+        loaded_module = _save_load_module(jit_module)
+        self._call_module(loaded_module)
+
+
 if __name__ == "__main__":
     unittest.main()
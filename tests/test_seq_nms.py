@@ -2,7 +2,20 @@ import unittest
 
 import torch
 
-from pt_seq_nms.seq_nms import _from_list_to_tensor, seq_nms, seq_nms_from_list
+from pt_seq_nms.seq_nms import (
+    seq_nms,
+    seq_nms_,
+    seq_nms_async,
+    seq_nms_batched,
+    seq_nms_bounded,
+    seq_nms_from_list,
+    seq_nms_packed,
+    seq_nms_stream,
+    seq_nms_sweep,
+    seq_nms_with_sequences,
+    seq_nms_with_stats,
+    seq_nms_workspace,
+)
 
 
 class TestE2ESeqNMS(unittest.TestCase):
@@ -43,40 +56,414 @@ class TestE2ESeqNMS(unittest.TestCase):
         self.assertEqual(updated_scores.shape, self.scores.shape)
         self.assertTrue(not torch.equal(updated_scores, self.scores.cuda()))
 
+    def test_op_without_options(self):
+        # the op called with the arguments it had before the options were added
+        updated_scores = torch.ops.seq_nms.seq_nms(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, "avg"
+        )
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
 
-class TestFromListToTensor(unittest.TestCase):
-    def test_fill(self):
-        boxes_list = [
-            torch.tensor([1, 2, 3, 4, 5, 6, 7, 8], dtype=torch.float32).view((2, 4)),
-            torch.tensor([9, 10, 11, 12], dtype=torch.float32).view((1, 4)),
-            torch.tensor([], dtype=torch.float32).view((0, 4)),
-        ]
+        future = torch.ops.seq_nms.seq_nms_async(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, "avg"
+        )
+        self.assertTrue(torch.equal(future.wait(), expected_scores))
 
-        scores_list = [
-            torch.tensor([0.5, 0.7], dtype=torch.float32),
-            torch.tensor([0.9], dtype=torch.float32),
-            torch.tensor([], dtype=torch.float32),
-        ]
+    def test_class_aware_one_class(self):
+        classes = torch.zeros_like(self.classes)
+        updated_scores = seq_nms(self.boxes, self.scores, classes, self.linkage_threshold, self.iou_threshold, class_aware=True)
+        expected_scores = seq_nms(self.boxes, self.scores, classes, self.linkage_threshold, self.iou_threshold)
 
-        classes_list = [
-            torch.tensor([1, 2], dtype=torch.int32),
-            torch.tensor([3], dtype=torch.int32),
-            torch.tensor([], dtype=torch.int32),
-        ]
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+
+    def test_class_aware_same_as_per_class(self):
+        updated_scores = seq_nms(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, class_aware=True
+        )
+
+        for class_idx in range(10):
+            # boxes of other classes with a zero score can neither link nor start a sequence
+            mask = self.classes == class_idx
+            class_scores = torch.where(mask, self.scores, torch.zeros_like(self.scores))
+            class_classes = torch.where(mask, self.classes, -torch.ones_like(self.classes))
+
+            expected_scores = seq_nms(self.boxes, class_scores, class_classes, self.linkage_threshold, self.iou_threshold)
+            self.assertTrue(torch.equal(updated_scores[mask], expected_scores[mask]))
+
+    def test_disjoint_sequences(self):
+        updated_scores = seq_nms(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, disjoint_sequences=True
+        )
+
+        self.assertEqual(updated_scores.shape, self.scores.shape)
+        self.assertTrue(not torch.equal(updated_scores, self.scores))
+
+    def test_disjoint_sequences_independent_objects(self):
+        # objects on a grid which move slightly between frames, so every object is one sequence and no sequences overlap
+        num_frames = self.boxes.shape[0]
+        grid = 100.0 * torch.arange(4, dtype=torch.float32)
+        offsets = torch.arange(num_frames, dtype=torch.float32)[:, None]
+
+        x1 = grid.repeat(4)[None, :] + offsets
+        y1 = grid.repeat_interleave(4)[None, :] + offsets
+        boxes = torch.stack([x1, y1, x1 + 20.0, y1 + 20.0], dim=-1)
+        scores = torch.rand((num_frames, 16), dtype=torch.float32)
+        classes = torch.zeros((num_frames, 16), dtype=torch.int32)
+
+        updated_scores = seq_nms(boxes, scores, classes, 0.5, 0.5, disjoint_sequences=True)
+        expected_scores = seq_nms(boxes, scores, classes, 0.5, 0.5)
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+
+    def test_score_threshold_same_as_masked(self):
+        score_threshold = 0.5
+        updated_scores = seq_nms(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, score_threshold=score_threshold
+        )
+
+        # boxes without a class and with a zero score can neither link nor start a sequence
+        mask = self.scores >= score_threshold
+        masked_scores = torch.where(mask, self.scores, torch.zeros_like(self.scores))
+        masked_classes = torch.where(mask, self.classes, -torch.ones_like(self.classes))
+        expected_scores = seq_nms(self.boxes, masked_scores, masked_classes, self.linkage_threshold, self.iou_threshold)
 
-        boxes, scores, classes = _from_list_to_tensor(boxes_list, scores_list, classes_list)
+        self.assertTrue(torch.equal(updated_scores[mask], expected_scores[mask]))
+        self.assertTrue(torch.equal(updated_scores[~mask], self.scores[~mask]))
 
-        expected_boxes = torch.tensor(
-            [1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0], dtype=torch.float32
-        ).view((3, 2, 4))
+    def test_score_threshold_below_all_scores(self):
+        updated_scores = seq_nms(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, score_threshold=0.0
+        )
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
 
-        expected_scores = torch.tensor([0.5, 0.7, 0.9, 0.0, 0.0, 0.0], dtype=torch.float32).view((3, 2))
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
 
-        expected_classes = torch.tensor([1, 2, 3, -1, -1, -1], dtype=torch.int32).view((3, 2))
+    def test_max_boxes_per_frame(self):
+        updated_scores = seq_nms(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, max_boxes_per_frame=5
+        )
 
-        self.assertTrue(torch.allclose(boxes, expected_boxes))
-        self.assertTrue(torch.allclose(scores, expected_scores))
-        self.assertTrue(torch.allclose(classes, expected_classes))
+        top_indices = torch.topk(self.scores, 5, dim=1).indices
+        mask = torch.zeros_like(self.scores, dtype=torch.bool).scatter_(1, top_indices, True)
+        self.assertTrue(torch.equal(updated_scores[~mask], self.scores[~mask]))
+        self.assertTrue(not torch.equal(updated_scores[mask], self.scores[mask]))
+
+    def test_with_stats(self):
+        updated_scores, stats = seq_nms_with_stats(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold
+        )
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+        self.assertGreater(stats["iterations"], 0)
+        self.assertGreaterEqual(stats["edges_built"], stats["edges_deleted"])
+        self.assertGreaterEqual(stats["nodes_visited"], self.scores.numel())
+        self.assertGreater(stats["peak_graph_bytes"], 0)
+        self.assertGreater(stats["overlap_index_bytes"], 0)
+        self.assertLess(stats["buffer_growths"], stats["iterations"])
+        for phase in ("build_ns", "dp_ns", "rescore_ns", "delete_ns"):
+            self.assertGreaterEqual(stats[phase], 0)
+
+    def test_with_sequences(self):
+        for class_aware in (False, True):
+            updated_scores, sequence_ids, sequence_scores, sequence_lengths = seq_nms_with_sequences(
+                self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, class_aware=class_aware
+            )
+            expected_scores = seq_nms(
+                self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, class_aware=class_aware
+            )
+
+            self.assertTrue(torch.equal(updated_scores, expected_scores))
+            self.assertEqual(sequence_ids.shape, self.scores.shape)
+            self.assertGreater(sequence_scores.numel(), 0)
+
+            # boxes without a sequence keep their scores, the boxes of a sequence have its score
+            unassigned = sequence_ids < 0
+            self.assertTrue(torch.equal(updated_scores[unassigned], self.scores[unassigned]))
+            self.assertTrue(torch.equal(updated_scores[~unassigned], sequence_scores[sequence_ids[~unassigned]]))
+            self.assertTrue(torch.equal(torch.bincount(sequence_ids[~unassigned]), sequence_lengths))
+
+    def test_bounded(self):
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+        updated_scores, stop_reason = seq_nms_bounded(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold
+        )
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+        self.assertEqual(stop_reason, "completed")
+
+        # only the boxes of the first sequence are rescored
+        updated_scores, stop_reason = seq_nms_bounded(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, max_sequences=1
+        )
+        _, sequence_ids, _, _ = seq_nms_with_sequences(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold
+        )
+        first_sequence = sequence_ids == 0
+        self.assertEqual(stop_reason, "max_sequences")
+        self.assertTrue(torch.equal(updated_scores[first_sequence], expected_scores[first_sequence]))
+        self.assertTrue(torch.equal(updated_scores[~first_sequence], self.scores[~first_sequence]))
+
+        updated_scores, stop_reason = seq_nms_bounded(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, deadline_ms=0.0
+        )
+        self.assertTrue(torch.equal(updated_scores, self.scores))
+        self.assertEqual(stop_reason, "deadline")
+
+    def test_sweep(self):
+        configs = [(0.2, "avg"), (0.5, "avg"), (0.5, "max")]
+        for class_aware, max_boxes_per_frame in ((False, None), (True, None), (False, 5)):
+            updated_scores = seq_nms_sweep(
+                self.boxes,
+                self.scores,
+                self.classes,
+                self.linkage_threshold,
+                configs,
+                class_aware=class_aware,
+                max_boxes_per_frame=max_boxes_per_frame,
+            )
+            self.assertEqual(updated_scores.shape, (len(configs),) + self.scores.shape)
+
+            for c_idx, (iou_threshold, metrics) in enumerate(configs):
+                expected_scores = seq_nms(
+                    self.boxes,
+                    self.scores,
+                    self.classes,
+                    self.linkage_threshold,
+                    iou_threshold,
+                    metrics,
+                    class_aware=class_aware,
+                    max_boxes_per_frame=max_boxes_per_frame,
+                )
+                self.assertTrue(torch.equal(updated_scores[c_idx], expected_scores))
+
+        updated_scores = seq_nms_sweep(self.boxes, self.scores, self.classes, self.linkage_threshold, [])
+        self.assertEqual(updated_scores.shape, (0,) + self.scores.shape)
+
+    def test_async(self):
+        # the clip and its flipped copy are in flight at once
+        clips = [(self.boxes, self.scores, self.classes), (self.boxes.flip(0), self.scores.flip(0), self.classes.flip(0))]
+        for class_aware in (False, True):
+            futures = [
+                seq_nms_async(boxes, scores, classes, self.linkage_threshold, self.iou_threshold, class_aware=class_aware)
+                for boxes, scores, classes in clips
+            ]
+            for future, (boxes, scores, classes) in zip(futures, clips):
+                expected_scores = seq_nms(
+                    boxes, scores, classes, self.linkage_threshold, self.iou_threshold, class_aware=class_aware
+                )
+                self.assertTrue(torch.equal(future.wait(), expected_scores))
+
+    def test_chunks(self):
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+
+        # a single chunk is the same as the whole clip
+        updated_scores = seq_nms(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, chunk_size=100
+        )
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+
+        updated_scores = seq_nms(
+            self.boxes,
+            self.scores,
+            self.classes,
+            self.linkage_threshold,
+            self.iou_threshold,
+            chunk_size=30,
+            chunk_overlap=10,
+        )
+        self.assertEqual(updated_scores.shape, expected_scores.shape)
+        self.assertTrue(torch.all((updated_scores >= 0.0) & (updated_scores <= 1.0)))
+
+    def test_other_dtypes(self):
+        # float64 holds the float32 boxes exactly and scores are rescored in float32, so only the returned type changes
+        updated_scores = seq_nms(
+            self.boxes.double(), self.scores.double(), self.classes.long(), self.linkage_threshold, self.iou_threshold
+        )
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+
+        self.assertEqual(updated_scores.dtype, torch.float64)
+        self.assertTrue(torch.equal(updated_scores, expected_scores.double()))
+
+        updated_scores = seq_nms(
+            self.boxes.half(), self.scores.half(), self.classes, self.linkage_threshold, self.iou_threshold
+        )
+        self.assertEqual(updated_scores.dtype, torch.float16)
+        self.assertEqual(updated_scores.shape, self.scores.shape)
+
+
+class TestE2ESeqNMSBatched(unittest.TestCase):
+    def setUp(self):
+        torch.random.manual_seed(42)
+        NUM_CLIPS = 4
+        NUM_FRAMES = 50
+
+        boxes = torch.empty((NUM_CLIPS, NUM_FRAMES, 20, 4), dtype=torch.float32)
+        width = 50.0 * torch.rand((NUM_CLIPS, NUM_FRAMES, 20), dtype=torch.float32)
+        height = 50.0 * torch.rand((NUM_CLIPS, NUM_FRAMES, 20), dtype=torch.float32)
+        x1 = 50.0 * torch.rand((NUM_CLIPS, NUM_FRAMES, 20), dtype=torch.float32)
+        y1 = 50.0 * torch.rand((NUM_CLIPS, NUM_FRAMES, 20), dtype=torch.float32)
+
+        boxes[:, :, :, 0] = x1
+        boxes[:, :, :, 1] = y1
+        boxes[:, :, :, 2] = x1 + width
+        boxes[:, :, :, 3] = y1 + height
+
+        classes = torch.randint(0, 10, (NUM_CLIPS, NUM_FRAMES, 20), dtype=torch.int32)
+        # pad the clips differently, so they are not equally expensive
+        classes[1, :, 10:] = -1
+        classes[3, 25:, :] = -1
+
+        self.boxes = boxes
+        self.scores = torch.rand((NUM_CLIPS, NUM_FRAMES, 20), dtype=torch.float32)
+        self.classes = classes
+
+        self.linkage_threshold = 0.3
+        self.iou_threshold = 0.2
+
+    def test_same_as_seq_nms(self):
+        updated_scores = seq_nms_batched(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+
+        self.assertEqual(updated_scores.shape, self.scores.shape)
+        for clip_idx in range(self.boxes.shape[0]):
+            expected_scores = seq_nms(
+                self.boxes[clip_idx],
+                self.scores[clip_idx],
+                self.classes[clip_idx],
+                self.linkage_threshold,
+                self.iou_threshold,
+            )
+            self.assertTrue(torch.equal(updated_scores[clip_idx], expected_scores))
+
+
+class TestE2ESeqNMSStream(unittest.TestCase):
+    def setUp(self):
+        torch.random.manual_seed(42)
+        NUM_FRAMES = 30
+
+        boxes = torch.empty((NUM_FRAMES, 20, 4), dtype=torch.float32)
+        width = 50.0 * torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+        height = 50.0 * torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+        x1 = 50.0 * torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+        y1 = 50.0 * torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+
+        boxes[:, :, 0] = x1
+        boxes[:, :, 1] = y1
+        boxes[:, :, 2] = x1 + width
+        boxes[:, :, 3] = y1 + height
+
+        self.boxes = boxes
+        self.scores = torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+        self.classes = torch.randint(0, 10, (NUM_FRAMES, 20), dtype=torch.int32)
+
+        self.linkage_threshold = 0.3
+        self.iou_threshold = 0.2
+
+    def test_same_as_seq_nms(self):
+        num_frames = self.boxes.shape[0]
+        stream = seq_nms_stream(self.linkage_threshold, self.iou_threshold, lookahead=num_frames)
+
+        for frame_idx in range(num_frames):
+            finalized = stream.push_frame(self.boxes[frame_idx], self.scores[frame_idx], self.classes[frame_idx])
+            self.assertEqual(len(finalized), 0)
+
+        updated_scores = torch.stack(stream.flush())
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+
+    def test_lookahead(self):
+        num_frames = self.boxes.shape[0]
+        lookahead = 5
+        stream = seq_nms_stream(self.linkage_threshold, self.iou_threshold, lookahead=lookahead)
+
+        for frame_idx in range(num_frames):
+            finalized = stream.push_frame(self.boxes[frame_idx], self.scores[frame_idx], self.classes[frame_idx])
+            self.assertEqual(len(finalized), 1 if frame_idx >= lookahead else 0)
+
+            if frame_idx >= lookahead:
+                # the finalized frame is rescored using the pending frames only
+                first_frame = frame_idx - lookahead
+                expected_scores = seq_nms(
+                    self.boxes[first_frame : frame_idx + 1],
+                    self.scores[first_frame : frame_idx + 1],
+                    self.classes[first_frame : frame_idx + 1],
+                    self.linkage_threshold,
+                    self.iou_threshold,
+                )
+                self.assertTrue(torch.equal(finalized[0], expected_scores[0]))
+
+        self.assertEqual(len(stream.flush()), lookahead)
+        self.assertEqual(stream.num_pending_frames(), 0)
+
+
+class TestE2ESeqNMSInPlace(unittest.TestCase):
+    def setUp(self):
+        torch.random.manual_seed(42)
+        NUM_FRAMES = 50
+
+        boxes = torch.empty((NUM_FRAMES, 20, 4), dtype=torch.float32)
+        width = 50.0 * torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+        height = 50.0 * torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+        x1 = 50.0 * torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+        y1 = 50.0 * torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+
+        boxes[:, :, 0] = x1
+        boxes[:, :, 1] = y1
+        boxes[:, :, 2] = x1 + width
+        boxes[:, :, 3] = y1 + height
+
+        self.boxes = boxes
+        self.scores = torch.rand((NUM_FRAMES, 20), dtype=torch.float32)
+        self.classes = torch.randint(0, 10, (NUM_FRAMES, 20), dtype=torch.int32)
+
+        self.linkage_threshold = 0.3
+        self.iou_threshold = 0.2
+
+    def test_same_as_seq_nms(self):
+        updated_scores = self.scores.clone()
+        returned_scores = seq_nms_(self.boxes, updated_scores, self.classes, self.linkage_threshold, self.iou_threshold)
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+        self.assertEqual(returned_scores.data_ptr(), updated_scores.data_ptr())
+
+    def test_reused_workspace(self):
+        workspace = seq_nms_workspace()
+
+        # clips of different lengths and options share the workspace
+        for num_frames, class_aware in [(50, False), (10, True), (30, False), (50, True)]:
+            boxes = self.boxes[:num_frames]
+            scores = self.scores[:num_frames]
+            classes = self.classes[:num_frames]
+
+            updated_scores = scores.clone()
+            seq_nms_(
+                boxes,
+                updated_scores,
+                classes,
+                self.linkage_threshold,
+                self.iou_threshold,
+                class_aware=class_aware,
+                workspace=workspace,
+            )
+            expected_scores = seq_nms(
+                boxes, scores, classes, self.linkage_threshold, self.iou_threshold, class_aware=class_aware
+            )
+            self.assertTrue(torch.equal(updated_scores, expected_scores))
+
+        # the largest clip was already seen, so the workspace doesn't grow
+        num_bytes = workspace.num_bytes()
+        seq_nms_(self.boxes, self.scores.clone(), self.classes, self.linkage_threshold, self.iou_threshold, workspace=workspace)
+        self.assertEqual(workspace.num_bytes(), num_bytes)
+
+        workspace.clear()
+        self.assertLess(workspace.num_bytes(), num_bytes)
+
+    def test_other_dtypes(self):
+        updated_scores = self.scores.double()
+        seq_nms_(self.boxes, updated_scores, self.classes, self.linkage_threshold, self.iou_threshold)
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+
+        self.assertEqual(updated_scores.dtype, torch.float64)
+        self.assertTrue(torch.equal(updated_scores, expected_scores.double()))
 
 
 class TestE2ESeqNMSList(unittest.TestCase):
@@ -121,6 +508,58 @@ class TestE2ESeqNMSList(unittest.TestCase):
     def test(self):
         _ = seq_nms_from_list(self.boxes_list, self.scores_list, self.classes_list, self.linkage_threshold, self.iou_threshold)
 
+    def test_same_as_padded(self):
+        updated_scores = seq_nms_from_list(
+            self.boxes_list, self.scores_list, self.classes_list, self.linkage_threshold, self.iou_threshold
+        )
+
+        # padded boxes have the class -1, so they aren't linked to any box
+        max_length = max(len(b) for b in self.boxes_list)
+        boxes = torch.zeros((len(self.boxes_list), max_length, 4), dtype=torch.float32)
+        scores = torch.zeros((len(self.boxes_list), max_length), dtype=torch.float32)
+        classes = -1 * torch.ones((len(self.boxes_list), max_length), dtype=torch.int32)
+        for frame_idx in range(len(self.boxes_list)):
+            num_boxes = len(self.boxes_list[frame_idx])
+            boxes[frame_idx, :num_boxes] = self.boxes_list[frame_idx]
+            scores[frame_idx, :num_boxes] = self.scores_list[frame_idx]
+            classes[frame_idx, :num_boxes] = self.classes_list[frame_idx]
+
+        expected_scores = seq_nms(boxes, scores, classes, self.linkage_threshold, self.iou_threshold)
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+
+    def test_row_elements(self):
+        # the scores and classes of the README example are [1, N_f] rather than [N_f]
+        boxes_list = [
+            torch.tensor([[20, 20, 40, 40], [10, 10, 20, 20]], dtype=torch.float),
+            torch.tensor([[20, 20, 35, 35]], dtype=torch.float),
+        ]
+        scores_list = [torch.tensor([[0.9, 0.7]], dtype=torch.float), torch.tensor([[0.7]], dtype=torch.float)]
+        classes_list = [torch.tensor([[0, 1]], dtype=torch.int), torch.tensor([[0]], dtype=torch.int)]
+
+        updated_scores = seq_nms_from_list(boxes_list, scores_list, classes_list, 0.5, 0.5)
+        expected_scores = seq_nms_from_list(
+            boxes_list, [s.view(-1) for s in scores_list], [c.view(-1) for c in classes_list], 0.5, 0.5
+        )
+        self.assertEqual(updated_scores.shape, (2, 2))
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+
+    def test_packed(self):
+        boxes = torch.cat(self.boxes_list)
+        scores = torch.cat(self.scores_list)
+        classes = torch.cat(self.classes_list)
+        frame_offsets = torch.zeros((len(self.boxes_list) + 1,), dtype=torch.int64)
+        frame_offsets[1:] = torch.cumsum(torch.tensor([len(b) for b in self.boxes_list]), dim=0)
+
+        updated_scores = seq_nms_packed(boxes, scores, classes, frame_offsets, self.linkage_threshold, self.iou_threshold)
+        self.assertEqual(updated_scores.shape, scores.shape)
+
+        expected_scores = seq_nms_from_list(
+            self.boxes_list, self.scores_list, self.classes_list, self.linkage_threshold, self.iou_threshold
+        )
+        for frame_idx in range(len(self.boxes_list)):
+            frame_scores = updated_scores[frame_offsets[frame_idx] : frame_offsets[frame_idx + 1]]
+            self.assertTrue(torch.equal(frame_scores, expected_scores[frame_idx, : len(frame_scores)]))
+
 
 if __name__ == "__main__":
     unittest.main()
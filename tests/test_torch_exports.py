@@ -41,6 +41,63 @@ class TestCompileSeqNMS(unittest.TestCase):
             self.boxes.cuda(), self.scores.cuda(), self.classes.cuda(), self.linkage_threshold, self.iou_threshold
         )
 
+    @unittest.skipIf(_under_version_two() or os.name == "nt", "Torch version < 2.0 or running on Windows")
+    def test_compile_without_graph_breaks(self):
+        explanation = torch._dynamo.explain(seq_nms)(
+            self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold
+        )
+        self.assertEqual(explanation.graph_break_count, 0)
+
+        compiled_seq_nms = torch.compile(seq_nms, fullgraph=True)
+        updated_scores = compiled_seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+        self.assertTrue(torch.equal(updated_scores, expected_scores))
+
+    def test_meta(self):
+        updated_scores = seq_nms(
+            self.boxes.to("meta"),
+            self.scores.to("meta"),
+            self.classes.to("meta"),
+            self.linkage_threshold,
+            self.iou_threshold,
+        )
+        self.assertEqual(updated_scores.device.type, "meta")
+        self.assertEqual(updated_scores.shape, self.scores.shape)
+        self.assertEqual(updated_scores.dtype, self.scores.dtype)
+
+    def test_opcheck(self):
+        args = (self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, "avg", False, False)
+        torch.library.opcheck(torch.ops.seq_nms.seq_nms.default, args + (None, None))
+        # writes to the scores, which the schema of seq_nms_ declares
+        torch.library.opcheck(
+            torch.ops.seq_nms.seq_nms_.default,
+            (self.boxes, self.scores.clone(), self.classes) + args[3:] + (None, None, None),
+        )
+        torch.library.opcheck(
+            torch.ops.seq_nms.seq_nms_batched.default,
+            (self.boxes[None], self.scores[None], self.classes[None]) + args[3:] + (None, None),
+        )
+        frame_offsets = torch.arange(0, self.scores.numel() + 1, self.scores.shape[1])
+        torch.library.opcheck(
+            torch.ops.seq_nms.seq_nms_packed.default,
+            (self.boxes.view(-1, 4), self.scores.view(-1), self.classes.view(-1), frame_offsets) + args[3:] + (None, None),
+        )
+        torch.library.opcheck(
+            torch.ops.seq_nms.seq_nms_chunked.default, args + (None, None), {"chunk_size": 4, "chunk_overlap": 2}
+        )
+        torch.library.opcheck(
+            torch.ops.seq_nms.seq_nms_sweep.default,
+            args[:4] + ([0.2, 0.5], ["avg", "max"]) + args[6:] + (None, None),
+        )
+
+    def test_out(self):
+        out = torch.empty(0)
+        updated_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold, out=out)
+        expected_scores = seq_nms(self.boxes, self.scores, self.classes, self.linkage_threshold, self.iou_threshold)
+
+        self.assertEqual(updated_scores.data_ptr(), out.data_ptr())
+        self.assertTrue(torch.equal(out, expected_scores))
+
 
 class TestCompileSeqNMSList(unittest.TestCase):
     def setUp(self):
@@ -0,0 +1,251 @@
+#include "detection_file.h"
+#include <ATen/Parallel.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+static uint64_t align_up(const uint64_t& num_bytes) {
+    return (num_bytes + DETECTION_FILE_ALIGNMENT - 1) / DETECTION_FILE_ALIGNMENT * DETECTION_FILE_ALIGNMENT;
+}
+
+static bool is_same_file(const std::string& path_a, const std::string& path_b) {
+    struct stat stat_a;
+    struct stat stat_b;
+    return (::stat(path_a.c_str(), &stat_a) == 0) && (::stat(path_b.c_str(), &stat_b) == 0) &&
+           (stat_a.st_dev == stat_b.st_dev) && (stat_a.st_ino == stat_b.st_ino);
+}
+
+static std::runtime_error io_error(const std::string& message, const std::string& path, const int& error) {
+    return std::runtime_error(message + " " + path + ": " + std::strerror(error));
+}
+
+detection_file_layout_t get_detection_file_layout(const detection_file_header_t& header) {
+    /*
+    Returns the byte offsets of the sections of a detection file with @header, see detection_file_header_t.
+    */
+
+    detection_file_layout_t layout;
+    layout.clip_offsets = align_up(sizeof(detection_file_header_t));
+    layout.frame_offsets = align_up(layout.clip_offsets + (header.num_clips + 1) * sizeof(uint64_t));
+    layout.boxes = align_up(layout.frame_offsets + (header.num_frames + 1) * sizeof(uint64_t));
+    layout.scores = align_up(layout.boxes + header.num_boxes * 4 * sizeof(float));
+    layout.classes = align_up(layout.scores + header.num_boxes * sizeof(float));
+    layout.num_bytes = layout.classes + header.num_boxes * sizeof(int32_t);
+    return layout;
+}
+
+static void validate_offsets(const uint64_t* offsets, const uint64_t& num_items, const uint64_t& end, const char* name) {
+    /*
+    Checks that the @num_items + 1 @offsets start at 0, end at @end and are non-decreasing.
+    */
+
+    if ((offsets[0] != 0) || (offsets[num_items] != end)) {
+        throw std::invalid_argument(std::string(name) + " are expected to start at 0 and end at the number of items");
+    }
+    for (uint64_t i = 0; i < num_items; i++) {
+        if (offsets[i + 1] < offsets[i]) {
+            throw std::invalid_argument(std::string(name) + " are expected to be non-decreasing");
+        }
+    }
+}
+
+DetectionFile::DetectionFile(const std::string& path, const bool& writable) : writable_(writable) {
+    /*
+    Maps the detection file at @path into memory, shared with the file if @writable is set, read-only otherwise.
+
+    The offsets of a read-only file are validated. A writable file is expected to be filled in by the caller, e.g.
+    after create_detection_file, so only its header and size are validated.
+    */
+
+    int fd = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        throw io_error("Can't open", path, errno);
+    }
+
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw io_error("Can't stat", path, error);
+    }
+    num_bytes_ = file_stat.st_size;
+    if (num_bytes_ < sizeof(detection_file_header_t)) {
+        ::close(fd);
+        throw std::invalid_argument("The detection file " + path + " is too small for its header");
+    }
+
+    void* data = ::mmap(nullptr, num_bytes_, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    int error = errno;
+    // the mapping keeps the file open
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        throw io_error("Can't map", path, error);
+    }
+    data_ = static_cast<uint8_t*>(data);
+
+    if (std::memcmp(header().magic, DETECTION_FILE_MAGIC, sizeof(DETECTION_FILE_MAGIC)) != 0) {
+        ::munmap(data_, num_bytes_);
+        throw std::invalid_argument("The file " + path + " is not a detection file");
+    }
+    if (header().version != DETECTION_FILE_VERSION) {
+        ::munmap(data_, num_bytes_);
+        throw std::invalid_argument("The detection file " + path + " has an unsupported version");
+    }
+    // every clip, frame and box takes at least a byte, which also keeps the layout of a corrupt header from overflowing
+    bool sizes_fit = (num_clips() < num_bytes_) && (num_frames() < num_bytes_) && (num_boxes() < num_bytes_);
+    layout_ = get_detection_file_layout(header());
+    if (!sizes_fit || (num_bytes_ < layout_.num_bytes)) {
+        ::munmap(data_, num_bytes_);
+        throw std::invalid_argument("The detection file " + path + " is smaller than its header says");
+    }
+
+    if (!writable) {
+        try {
+            validate_offsets(clip_offsets(), num_clips(), num_frames(), "clip_offsets");
+            validate_offsets(frame_offsets(), num_frames(), num_boxes(), "frame_offsets");
+        } catch (...) {
+            ::munmap(data_, num_bytes_);
+            throw;
+        }
+    }
+}
+
+DetectionFile::~DetectionFile() {
+    ::munmap(data_, num_bytes_);
+}
+
+uint8_t* DetectionFile::mutable_data() {
+    if (!writable_) {
+        throw std::logic_error("The detection file is expected to be opened as writable");
+    }
+    return data_;
+}
+
+uint64_t* DetectionFile::mutable_clip_offsets() {
+    return reinterpret_cast<uint64_t*>(mutable_data() + layout_.clip_offsets);
+}
+
+uint64_t* DetectionFile::mutable_frame_offsets() {
+    return reinterpret_cast<uint64_t*>(mutable_data() + layout_.frame_offsets);
+}
+
+float* DetectionFile::mutable_boxes() {
+    return reinterpret_cast<float*>(mutable_data() + layout_.boxes);
+}
+
+float* DetectionFile::mutable_scores() {
+    return reinterpret_cast<float*>(mutable_data() + layout_.scores);
+}
+
+int32_t* DetectionFile::mutable_classes() {
+    return reinterpret_cast<int32_t*>(mutable_data() + layout_.classes);
+}
+
+void create_detection_file(
+    const std::string& path,
+    const uint64_t& num_clips,
+    const uint64_t& num_frames,
+    const uint64_t& num_boxes) {
+    /*
+    Creates a detection file at @path, or truncates an existing one, with the given sizes. Everything but the header is
+    zero, the sections are expected to be filled in through a writable DetectionFile.
+    */
+
+    detection_file_header_t header = {};
+    std::memcpy(header.magic, DETECTION_FILE_MAGIC, sizeof(DETECTION_FILE_MAGIC));
+    header.version = DETECTION_FILE_VERSION;
+    header.num_clips = num_clips;
+    header.num_frames = num_frames;
+    header.num_boxes = num_boxes;
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw io_error("Can't create", path, errno);
+    }
+    // the file is sized first, so the sections are sparse until they are written
+    bool written = ::ftruncate(fd, get_detection_file_layout(header).num_bytes) == 0 &&
+                   ::pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+    int error = errno;
+    ::close(fd);
+    if (!written) {
+        throw io_error("Can't write", path, error);
+    }
+}
+
+void rescore_detection_file(
+    const std::string& input_path,
+    const std::string& output_path,
+    const seq_nms_options_t& options) {
+    /*
+    Applies the seq-nms algorithm to every clip of the detection file at @input_path and writes the clips with the
+    updated scores to a new detection file at @output_path, see rescore_packed_clip.
+
+    The clips are processed in parallel, each thread takes the next clip in file order when it is done with its current
+    one so the files are read and written roughly sequentially. Boxes and classes are read straight from the mapped
+    input, every thread keeps its own seq_nms_buffers_t so memory is only allocated for clips larger than the ones
+    before.
+    */
+
+    DetectionFile input(input_path, false);
+    // creating the output truncates it
+    if (is_same_file(input_path, output_path)) {
+        throw std::invalid_argument("The output is expected to be a different file than the input");
+    }
+    create_detection_file(output_path, input.num_clips(), input.num_frames(), input.num_boxes());
+    DetectionFile output(output_path, true);
+
+    std::memcpy(output.mutable_clip_offsets(), input.clip_offsets(), (input.num_clips() + 1) * sizeof(uint64_t));
+    std::memcpy(output.mutable_frame_offsets(), input.frame_offsets(), (input.num_frames() + 1) * sizeof(uint64_t));
+
+    std::atomic<uint64_t> next_clip{0};
+    int64_t num_workers = std::min<int64_t>(at::get_num_threads(), input.num_clips());
+    at::parallel_for(0, num_workers, 1, [&](int64_t begin, int64_t end) {
+        seq_nms_buffers_t buffers;
+        std::vector<int> frame_offsets;
+        torch::Tensor clip_scores;
+
+        for (uint64_t c_idx = next_clip++; c_idx < input.num_clips(); c_idx = next_clip++) {
+            uint64_t first_frame = input.clip_offsets()[c_idx];
+            uint64_t last_frame = input.clip_offsets()[c_idx + 1];
+            uint64_t first_box = input.frame_offsets()[first_frame];
+            uint64_t num_boxes = input.frame_offsets()[last_frame] - first_box;
+
+            // boxes are indexed with int within a clip
+            if (num_boxes > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+                throw std::invalid_argument("A clip of the detection file has too many boxes");
+            }
+
+            frame_offsets.resize(last_frame - first_frame + 1);
+            for (uint64_t f_idx = first_frame; f_idx <= last_frame; f_idx++) {
+                frame_offsets[f_idx - first_frame] = input.frame_offsets()[f_idx] - first_box;
+            }
+
+            // the input is mapped read-only and only read through these tensors
+            auto boxes = torch::from_blob(
+                const_cast<float*>(input.boxes() + 4 * first_box), {static_cast<int64_t>(num_boxes), 4}, torch::kFloat32);
+            auto classes = torch::from_blob(
+                const_cast<int32_t*>(input.classes() + first_box), {static_cast<int64_t>(num_boxes)}, torch::kInt32);
+
+            if (clip_scores.defined()) {
+                clip_scores.resize_({static_cast<int64_t>(num_boxes)});
+            } else {
+                clip_scores = torch::empty({static_cast<int64_t>(num_boxes)}, torch::kFloat32);
+            }
+            std::memcpy(clip_scores.data_ptr<float>(), input.scores() + first_box, num_boxes * sizeof(float));
+
+            rescore_packed_clip(boxes, clip_scores, classes, frame_offsets, options, buffers);
+
+            float* output_boxes = output.mutable_boxes() + 4 * first_box;
+            std::memcpy(output_boxes, input.boxes() + 4 * first_box, num_boxes * 4 * sizeof(float));
+            std::memcpy(output.mutable_scores() + first_box, clip_scores.data_ptr<float>(), num_boxes * sizeof(float));
+            std::memcpy(output.mutable_classes() + first_box, input.classes() + first_box, num_boxes * sizeof(int32_t));
+        }
+    });
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "seq_nms.h"
+
+// "SEQNMSD" followed by a zero byte
+const char DETECTION_FILE_MAGIC[8] = {'S', 'E', 'Q', 'N', 'M', 'S', 'D', '\0'};
+const uint32_t DETECTION_FILE_VERSION = 1;
+// every section starts at a multiple of this many bytes
+const uint64_t DETECTION_FILE_ALIGNMENT = 64;
+
+struct detection_file_header_t {
+    /*
+    The first 64 bytes of a detection file. A detection file holds the detections of several clips in columnar layout,
+    little endian and in this order, every section starting at a multiple of DETECTION_FILE_ALIGNMENT bytes:
+
+        clip_offsets    uint64 [num_clips + 1]      the frames of clip c are clip_offsets[c]:clip_offsets[c + 1]
+        frame_offsets   uint64 [num_frames + 1]     the boxes of frame f are frame_offsets[f]:frame_offsets[f + 1]
+        boxes           float32 [num_boxes, 4]      [x_min, y_min, x_max, y_max]
+        scores          float32 [num_boxes]
+        classes         int32 [num_boxes]           boxes with a class < 0 are skipped, same as for seq_nms
+    */
+
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t num_clips;
+    uint64_t num_frames;
+    uint64_t num_boxes;
+    uint64_t padding[3];
+};
+
+static_assert(sizeof(detection_file_header_t) == 64, "the header of a detection file is expected to be 64 bytes");
+
+struct detection_file_layout_t {
+    /*
+    The byte offsets of the sections of a detection file, see detection_file_header_t.
+    */
+
+    uint64_t clip_offsets;
+    uint64_t frame_offsets;
+    uint64_t boxes;
+    uint64_t scores;
+    uint64_t classes;
+    uint64_t num_bytes;
+};
+
+detection_file_layout_t get_detection_file_layout(const detection_file_header_t& header);
+
+class DetectionFile {
+    /*
+    A detection file mapped into memory, see detection_file_header_t. The file is validated when it is opened, so the
+    offsets of a DetectionFile can be used without further checks.
+
+    Only the pages which are read or written are loaded, so files much larger than the memory can be processed.
+    */
+
+  public:
+    DetectionFile(const std::string& path, const bool& writable);
+    DetectionFile(const DetectionFile&) = delete;
+    DetectionFile& operator=(const DetectionFile&) = delete;
+    ~DetectionFile();
+
+    uint64_t num_clips() const {
+        return header().num_clips;
+    }
+
+    uint64_t num_frames() const {
+        return header().num_frames;
+    }
+
+    uint64_t num_boxes() const {
+        return header().num_boxes;
+    }
+
+    const detection_file_header_t& header() const {
+        return *reinterpret_cast<const detection_file_header_t*>(data_);
+    }
+
+    const uint64_t* clip_offsets() const {
+        return reinterpret_cast<const uint64_t*>(data_ + layout_.clip_offsets);
+    }
+
+    const uint64_t* frame_offsets() const {
+        return reinterpret_cast<const uint64_t*>(data_ + layout_.frame_offsets);
+    }
+
+    const float* boxes() const {
+        return reinterpret_cast<const float*>(data_ + layout_.boxes);
+    }
+
+    const float* scores() const {
+        return reinterpret_cast<const float*>(data_ + layout_.scores);
+    }
+
+    const int32_t* classes() const {
+        return reinterpret_cast<const int32_t*>(data_ + layout_.classes);
+    }
+
+    // the sections of a file opened as writable
+    uint64_t* mutable_clip_offsets();
+    uint64_t* mutable_frame_offsets();
+    float* mutable_boxes();
+    float* mutable_scores();
+    int32_t* mutable_classes();
+
+  private:
+    uint8_t* mutable_data();
+
+    uint8_t* data_;
+    uint64_t num_bytes_;
+    bool writable_;
+    detection_file_layout_t layout_;
+};
+
+void create_detection_file(
+    const std::string& path,
+    const uint64_t& num_clips,
+    const uint64_t& num_frames,
+    const uint64_t& num_boxes);
+
+void rescore_detection_file(
+    const std::string& input_path,
+    const std::string& output_path,
+    const seq_nms_options_t& options);
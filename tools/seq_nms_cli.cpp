@@ -0,0 +1,91 @@
+#include <ATen/Parallel.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "detection_file.h"
+#include "seq_nms.h"
+
+// the format of the detection files is described in detection_file_header_t
+static const char* USAGE =
+    "Usage: seq_nms_cli [options] INPUT OUTPUT\n"
+    "\n"
+    "Applies seq-nms to every clip of the detection file INPUT and writes the clips with the updated scores to OUTPUT.\n"
+    "\n"
+    "Options:\n"
+    "  --linkage-threshold X     threshold for linking boxes in consecutive frames (default 0.5)\n"
+    "  --iou-threshold X         threshold for suppressing boxes overlapping a sequence (default 0.5)\n"
+    "  --metric avg|max          how a sequence is rescored (default avg)\n"
+    "  --class-aware             a sequence only suppresses boxes of its own class\n"
+    "  --disjoint-sequences      take every non-conflicting sequence before the best paths are solved again\n"
+    "  --score-threshold X       only boxes with a score of at least X take part in seq-nms\n"
+    "  --max-boxes-per-frame N   only the N highest scoring boxes of each frame take part in seq-nms\n"
+    "  --threads N               number of clips processed in parallel (default: the number of cores)\n";
+
+int main(int argc, char** argv) {
+    double linkage_threshold = 0.5;
+    double iou_threshold = 0.5;
+    std::string metric = "avg";
+    bool class_aware = false;
+    bool disjoint_sequences = false;
+    c10::optional<double> score_threshold;
+    c10::optional<int64_t> max_boxes_per_frame;
+    std::vector<std::string> paths;
+    seq_nms_options_t options;
+
+    // errors in the arguments also print the usage
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            // the value of an option which takes one
+            auto value = [&]() {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument(arg + " is expected to have a value");
+                }
+                return std::string(argv[++i]);
+            };
+
+            if (arg == "--linkage-threshold") {
+                linkage_threshold = std::stod(value());
+            } else if (arg == "--iou-threshold") {
+                iou_threshold = std::stod(value());
+            } else if (arg == "--metric") {
+                metric = value();
+            } else if (arg == "--class-aware") {
+                class_aware = true;
+            } else if (arg == "--disjoint-sequences") {
+                disjoint_sequences = true;
+            } else if (arg == "--score-threshold") {
+                score_threshold = std::stod(value());
+            } else if (arg == "--max-boxes-per-frame") {
+                max_boxes_per_frame = std::stoll(value());
+            } else if (arg == "--threads") {
+                at::set_num_threads(std::stoi(value()));
+            } else if (arg == "-h" || arg == "--help") {
+                std::cout << USAGE;
+                return EXIT_SUCCESS;
+            } else if (arg.rfind("--", 0) == 0) {
+                throw std::invalid_argument("Unknown option " + arg);
+            } else {
+                paths.push_back(arg);
+            }
+        }
+        if (paths.size() != 2) {
+            throw std::invalid_argument("An input and an output file are expected");
+        }
+
+        options = to_seq_nms_options(
+            linkage_threshold, iou_threshold, metric, class_aware, disjoint_sequences, score_threshold, max_boxes_per_frame);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n\n" << USAGE;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        rescore_detection_file(paths[0], paths[1], options);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}